@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+#
+# Time per executed bytecode opcode of 'opcodes.eg', for one or
+# more interpreters, for instance a build before and after a
+# change to the dispatch loop. Opcodes are counted by the first
+# interpreter that reports them in its statistics, the time is
+# the wall time of the reduction and includes the work the
+# combinators do besides dispatching.
+#
+#   usage: opbench.sh [n] [egel..]
+
+N=${1:-200000}
+shift
+BINS=${@:-${EGEL:-egel}}
+
+cd "$(dirname "$0")"
+
+stat() {
+    echo "$1" | grep -o "\"$2\": [0-9]*" | head -1 | awk '{ print $2 }'
+}
+
+OPS=
+for B in $BINS; do
+    S=$(OPCODES_N=$N $B -S opcodes.eg 2>&1 > /dev/null)
+    WALL[${#WALL[@]}]=$(stat "$S" wall_ns)
+    [ -z "$OPS" ] && OPS=$(stat "$S" opcodes)
+done
+
+printf "%-32s %12s %10s\n" egel opcodes ns/opcode
+I=0
+for B in $BINS; do
+    printf "%-32s %12s %10s\n" $B $OPS \
+        $(echo "${WALL[$I]} $OPS" | awk '{ printf "%.2f", $1 / $2 }')
+    I=$((I + 1))
+done
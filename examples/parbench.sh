@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+#
+# Speedup curve of 'parfib.eg' from one worker up to one per core,
+# relative to a fully sequential run (threshold zero).
+#
+#   usage: parbench.sh [n] [threshold]
+
+EGEL=${EGEL:-egel}
+N=${1:-27}
+T=${2:-16}
+
+cd "$(dirname "$0")"
+
+run() {
+    local s=$(date +%s.%N)
+    PARFIB_N=$N PARFIB_THRESHOLD=$2 $EGEL -W $1 parfib.eg > /dev/null
+    local e=$(date +%s.%N)
+    echo "$s $e" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+SEQ=$(run 1 0)
+printf "%-8s %8s %8s\n" workers seconds speedup
+printf "%-8s %8s %8s\n" seq $SEQ 1.00
+for W in $(seq 1 $(nproc)); do
+    P=$(run $W $T)
+    printf "%-8s %8s %8s\n" $W $P $(echo "$SEQ $P" | awk '{ printf "%.2f", $1 / $2 }')
+done
@@ -27,8 +27,8 @@ public:
         return VMObjectPtr(new Dictionary(m, d));
     }
 
-    static std::shared_ptr<Dictionary> cast(const VMObjectPtr& o) {
-        return std::static_pointer_cast<Dictionary>(o);
+    static VMObjectRef<Dictionary> cast(const VMObjectPtr& o) {
+        return vm_object_cast<Dictionary>(o);
     }
 
     int compare(const VMObjectPtr& o) override {
@@ -93,7 +93,7 @@ public:
             auto d = Dictionary::cast(arg0);
             return m->create_bool(d->has(arg1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -110,7 +110,7 @@ public:
             auto d = Dictionary::cast(arg0);
             return d->get(arg1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -128,7 +128,8 @@ public:
             d->set(arg1, arg2);
             return arg0;
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -146,7 +147,7 @@ public:
             d->erase(arg1);
             return d;
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -163,7 +164,7 @@ public:
             auto oo = d->keys();
             return m->to_list(oo);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -60,10 +60,10 @@ public:
 
                 return path_to_object(p0);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -84,10 +84,10 @@ public:
 
                 return path_to_object(p0);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -105,10 +105,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -126,10 +126,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -147,10 +147,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -169,10 +169,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -191,10 +191,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -212,10 +212,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -233,10 +233,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -254,10 +254,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -275,10 +275,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -296,10 +296,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -317,10 +317,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -338,10 +338,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -359,10 +359,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -380,10 +380,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -401,10 +401,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -422,10 +422,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -443,10 +443,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -464,10 +464,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -485,10 +485,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -506,10 +506,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -528,10 +528,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -552,10 +552,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -576,10 +576,10 @@ override { if ((machine()->is_text(arg0)) && (machine()->is_text(arg1))) { try {
 
                 return path_to_object(p2);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -600,10 +600,10 @@ override { if ((machine()->is_text(arg0)) && (machine()->is_text(arg1))) { try {
 
                 return path_to_object(p2);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -625,10 +625,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -649,10 +649,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -673,10 +673,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -696,10 +696,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -719,10 +719,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -743,10 +743,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -767,10 +767,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -792,10 +792,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -811,7 +811,7 @@ public:
 
             return path_to_object(p);
         } catch (const fs::filesystem_error& e) {
-            throw error_to_object(e);
+            return machine()->raise(error_to_object(e));
         }
     }
 };
@@ -830,10 +830,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -852,10 +852,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -877,10 +877,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -899,10 +899,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -922,10 +922,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -947,10 +947,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -974,10 +974,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -998,10 +998,10 @@ override { if ((machine()->is_text(arg0)) && (machine()->is_integer(arg1))) {
 
                 return machine->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -1022,10 +1022,10 @@ override { if ((machine()->is_text(arg0)) && (machine()->is_integer(arg1))) {
 
                 return machine->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -1045,10 +1045,10 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1067,10 +1067,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1090,10 +1090,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1114,10 +1114,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -1139,10 +1139,10 @@ public:
 
                 return machine()->create_none();
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -1161,10 +1161,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1183,10 +1183,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1205,10 +1205,10 @@ public:
 
                 return machine()->create_integer(n);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1229,7 +1229,7 @@ public:
 
             return path_to_object(p);
         } catch (const fs::filesystem_error& e) {
-            throw error_to_object(e);
+            return machine()->raise(error_to_object(e));
         }
     }
 };
@@ -1248,10 +1248,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1272,10 +1272,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1294,10 +1294,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1317,10 +1317,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1339,10 +1339,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1361,10 +1361,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1384,10 +1384,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1406,10 +1406,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1428,10 +1428,10 @@ public:
 
                 return machine()->create_bool(b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -1453,10 +1453,10 @@ public:
 
                 return paths_to_list(machine(), ff);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
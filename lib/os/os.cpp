@@ -300,7 +300,7 @@ public:
         } while ((n > 0) && (ch != '\n'));
 
         auto s = UnicodeString::fromUTF8(StringPiece(str, count));
-        delete str;
+        free(str);
         return s;
     }
 
@@ -377,7 +377,7 @@ public:
     }
 
     int compare(const VMObjectPtr& o) override {
-        auto v = (std::static_pointer_cast<ChannelValue>(o))->value();
+        auto v = (vm_object_cast<ChannelValue>(o))->value();
         if (_value < v)
             return -1;
         else if (v < _value)
@@ -400,7 +400,7 @@ protected:
 
 #define CHANNEL_TEST(o, sym) \
     ((machine()->is_opaque(o)) && (VM_OBJECT_OPAQUE_SYMBOL(o) == sym))
-#define CHANNEL_VALUE(o) ((std::static_pointer_cast<ChannelValue>(o))->value())
+#define CHANNEL_VALUE(o) ((vm_object_cast<ChannelValue>(o))->value())
 
 //## OS::cin - standard input channel
 class Stdin : public Medadic {
@@ -486,7 +486,7 @@ public:
             auto channel = ChannelValue::create(machine(), stream);
             return channel;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -503,7 +503,7 @@ public:
             auto channel = ChannelValue::create(machine(), stream);
             return channel;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -514,15 +514,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, Close, "OS", "close");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             chan->close();
             return machine()->create_none();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -533,15 +533,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, Read, "OS", "read");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             UnicodeString str = chan->read();
             return machine()->create_text(str);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -552,15 +552,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, ReadLine, "OS", "read_line");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             UnicodeString str = chan->read_line();
             return machine()->create_text(str);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -571,15 +571,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, ReadAll, "OS", "read_all");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             UnicodeString str = chan->read_all();
             return machine()->create_text(str);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -591,8 +591,8 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr& arg0,
                       const VMObjectPtr& arg1) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
@@ -601,10 +601,10 @@ public:
                 chan->write(s);
                 return machine()->create_none();
             } else {
-                throw machine()->bad_args(this, arg0, arg1);
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -616,8 +616,8 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr& arg0,
                       const VMObjectPtr& arg1) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
@@ -626,10 +626,10 @@ public:
                 chan->write_line(s);
                 return machine()->create_none();
             } else {
-                throw machine()->bad_args(this, arg0, arg1);
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -640,15 +640,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, Flush, "OS", "flush");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             chan->flush();
             return machine()->create_none();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -659,14 +659,14 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, Eof, "OS", "eof");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "channel");
+        static VMSymbol channel_symbol("OS", "channel");
+        symbol_t sym = channel_symbol(machine());
 
         if (CHANNEL_TEST(arg0, sym)) {
             auto chan = CHANNEL_VALUE(arg0);
             return machine()->create_bool(chan->eof());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -692,7 +692,7 @@ public:
                 m, cn);  // lock will be released when object destroyed
             return c;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -711,7 +711,7 @@ public:
             // play nice
             return machine()->create_none();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -741,7 +741,7 @@ public:
     int compare(const VMObjectPtr& o) override {
         // XXX: not the foggiest idea whether this words.
         // I assume file descriptors are unique.
-        auto v = (std::static_pointer_cast<ServerObject>(o));
+        auto v = (vm_object_cast<ServerObject>(o));
         if (_sockfd < v->_sockfd) {
             return -1;
         } else if (_sockfd > v->_sockfd) {
@@ -793,7 +793,7 @@ protected:
 
 #define SERVER_OBJECT_TEST(o, sym) \
     ((machine()->is_opaque(o)) && (VM_OBJECT_OPAQUE_SYMBOL(o) == sym))
-#define SERVER_OBJECT_CAST(o) (std::static_pointer_cast<ServerObject>(o))
+#define SERVER_OBJECT_CAST(o) (vm_object_cast<ServerObject>(o))
 
 //## OS::accept serverobject - accept connections
 class Accept : public Monadic {
@@ -801,15 +801,15 @@ public:
     MONADIC_PREAMBLE(VM_SUB_EGO, Accept, "OS", "accept");
 
     VMObjectPtr apply(const VMObjectPtr& arg0) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("OS", "serverobject");
+        static VMSymbol serverobject_symbol("OS", "serverobject");
+        symbol_t sym = serverobject_symbol(machine());
 
         if (SERVER_OBJECT_TEST(arg0, sym)) {
             auto so = SERVER_OBJECT_CAST(arg0);
             auto chan = so->accept();
             return chan;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -830,7 +830,7 @@ public:
 
             return so;
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -851,7 +851,8 @@ public:
 
             sockfd = socket(AF_INET, SOCK_STREAM, 0);
             if (sockfd < 0) {
-                throw machine()->create_text("error opening socket");
+                return machine()->raise(
+                    machine()->create_text("error opening socket"));
             }
 
             bzero((char*)&server_address, sizeof(server_address));
@@ -863,12 +864,14 @@ public:
             // Convert IPv4 and IPv6 addresses from text to binary form
             if (::inet_pton(AF_INET, utf8.c_str(), &server_address.sin_addr) <=
                 0) {
-                throw machine()->create_text("invalid address");
+                return machine()->raise(
+                    machine()->create_text("invalid address"));
             }
 
             if (::connect(sockfd, (struct sockaddr*)&server_address,
                           sizeof(server_address)) < 0) {
-                throw machine()->create_text("connection failed");
+                return machine()->raise(
+                    machine()->create_text("connection failed"));
             }
 
             auto cn = ChannelFD::create(sockfd);
@@ -876,7 +879,7 @@ public:
             return c;
 
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -39,8 +39,8 @@ public:
         return VMObjectPtr(new PQueue(m, d));
     }
 
-    static std::shared_ptr<PQueue> cast(const VMObjectPtr& o) {
-        return std::static_pointer_cast<PQueue>(o);
+    static VMObjectRef<PQueue> cast(const VMObjectPtr& o) {
+        return vm_object_cast<PQueue>(o);
     }
 
     int compare(const VMObjectPtr& o) override {
@@ -102,7 +102,7 @@ public:
             auto d = PQueue::cast(arg0);
             return m->create_bool(d->empty());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -118,7 +118,7 @@ public:
             auto d = PQueue::cast(arg0);
             return d->top();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -135,7 +135,7 @@ public:
             d->pop();
             return arg0;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -153,7 +153,8 @@ public:
             d->push(arg1, arg2);
             return arg0;
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
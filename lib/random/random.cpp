@@ -47,7 +47,7 @@ public:
             return machine()->create_integer(random::get().between(i0, i1));
         } else {
             // XXX: extend once with two float values
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
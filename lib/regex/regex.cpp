@@ -26,7 +26,7 @@ VMObjectPtr strings_to_list(VM* vm, UnicodeStrings ss) {
 
 //## Regex::pattern - an opaque object holding a pattern
 class Regex;
-typedef std::shared_ptr<Regex> RegexPtr;
+typedef VMObjectRef<Regex> RegexPtr;
 
 class Regex : public Opaque {
 public:
@@ -48,7 +48,7 @@ public:
 
     int compare(const VMObjectPtr& o) override {
         if ((machine()->is_opaque(o)) && (o->symbol() == this->symbol())) {
-            RegexPtr r = std::static_pointer_cast<Regex>(o);
+            RegexPtr r = vm_object_cast<Regex>(o);
             if (string() < r->string()) {
                 return -1;
             } else if (r->string() < string()) {
@@ -98,7 +98,7 @@ public:
     }
 
     static RegexPtr regex_pattern_cast(const VMObjectPtr& o) {
-        return std::static_pointer_cast<Regex>(o);
+        return vm_object_cast<Regex>(o);
     }
 
 private:
@@ -119,12 +119,12 @@ public:
             icu::RegexPattern* p =
                 icu::RegexPattern::compile(pat, parse_error, error_code);
             if (U_FAILURE(error_code)) {
-                throw machine()->bad_args(this, arg0);
+                return machine()->raise(machine()->bad_args(this, arg0));
             } else {
                 return Regex::create(this->machine(), p);
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -141,7 +141,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UErrorCode error_code = U_ZERO_ERROR;
             auto b = r->matches(error_code);
@@ -149,7 +150,7 @@ public:
 
             return machine()->create_bool(b);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -166,7 +167,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UErrorCode error_code = U_ZERO_ERROR;
             auto b = r->lookingAt(error_code);
@@ -174,7 +176,7 @@ public:
 
             return machine()->create_bool(b);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -192,7 +194,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UErrorCode error_code = U_ZERO_ERROR;
             auto b = r->lookingAt(error_code);
@@ -205,7 +208,7 @@ public:
                 return machine()->create_none();
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -222,7 +225,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UnicodeStrings ss;
             int32_t pos = 0;
@@ -246,7 +250,7 @@ public:
 
             return strings_to_list(machine(), ss);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -263,7 +267,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UnicodeStrings ss;
             while (r->find()) {
@@ -279,7 +284,7 @@ public:
 
             return strings_to_list(machine(), ss);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -299,19 +304,23 @@ public:
             auto s1 = machine()->get_text(arg2);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1, arg2);
+            if (r == nullptr)
+                return machine()->raise(
+                    machine()->bad_args(this, arg0, arg1, arg2));
 
             UErrorCode error_code = U_ZERO_ERROR;
             auto s2 = r->replaceFirst(s1, error_code);
             delete r;
 
             if (U_FAILURE(error_code)) {
-                throw machine()->bad_args(this, arg0, arg1, arg2);
+                return machine()->raise(
+                    machine()->bad_args(this, arg0, arg1, arg2));
             } else {
                 return VMObjectText::create(s2);
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -331,19 +340,23 @@ public:
             auto s1 = machine()->get_text(arg2);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1, arg2);
+            if (r == nullptr)
+                return machine()->raise(
+                    machine()->bad_args(this, arg0, arg1, arg2));
 
             UErrorCode error_code = U_ZERO_ERROR;
             auto s2 = r->replaceAll(s1, error_code);
             delete r;
 
             if (U_FAILURE(error_code)) {
-                throw machine()->bad_args(this, arg0, arg1, arg2);
+                return machine()->raise(
+                    machine()->bad_args(this, arg0, arg1, arg2));
             } else {
                 return VMObjectText::create(s2);
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -360,7 +373,8 @@ public:
             auto s0 = machine()->get_text(arg1);
 
             auto r = pat->matcher(s0);
-            if (r == nullptr) throw machine()->bad_args(this, arg0, arg1);
+            if (r == nullptr)
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
 
             UnicodeStrings ss;
             UErrorCode error_code = U_ZERO_ERROR;
@@ -378,7 +392,7 @@ public:
 
             return strings_to_list(machine(), ss);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -212,7 +212,7 @@ public:
     }
 
     int compare(const VMObjectPtr& o) override {
-        auto v = (std::static_pointer_cast<FlatClock>(o))->value();
+        auto v = (vm_object_cast<FlatClock>(o))->value();
         if (_value < v)
             return -1;
         else if (v < _value)
@@ -246,7 +246,7 @@ public:
 
                 return bool_to_object(machine(), b);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
             THROW_BADARGS;
@@ -267,7 +267,7 @@ public:
 
                 return path_to_object(p1);
             } catch (const fs::filesystem_error& e) {
-                throw error_to_object(e);
+                return machine()->raise(error_to_object(e));
             }
         } else {
             THROW_BADARGS;
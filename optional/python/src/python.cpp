@@ -199,7 +199,7 @@ public:
     OPAQUE_PREAMBLE(VM_SUB_PYTHON_OBJECT, PythonMachine, "Python", "machine");
 
     static VMObjectPtr create(VM* m) {
-        return std::make_shared<PythonMachine>(m);  // XXX: closes and creates?
+        return VMObjectPtr(new PythonMachine(m));  // XXX: closes and creates?
     }
 
     ~PythonMachine() {
@@ -209,7 +209,7 @@ public:
     int compare(const VMObjectPtr& o) override {
         return false;
         /* XXX: for later
-        auto v = (std::static_pointer_cast<PythonMachine>(o))->value();
+        auto v = (vm_object_cast<PythonMachine>(o))->value();
         if (_value < v) return -1;
         else if (v < _value) return 1;
         else return 0;
@@ -233,14 +233,14 @@ protected:
 #define PYTHON_MACHINE_TEST(o)                \
     ((o->subtag() == VM_SUB_PYTHON_OBJECT) && \
      (o->to_text() == "Python:::machine"))
-#define PYTHON_MACHINE_CAST(o) std::static_pointer_cast<PythonMachine>(o)
+#define PYTHON_MACHINE_CAST(o) vm_object_cast<PythonMachine>(o)
 
 /**
  * A Python object.
  **/
 
 class PythonObject;
-typedef std::shared_ptr<PythonObject> PythonObjectPtr;
+typedef VMObjectRef<PythonObject> PythonObjectPtr;
 
 //## Python::object - opaque Python object values
 class PythonObject : public Opaque {
@@ -256,11 +256,11 @@ public:
     }
 
     VMObjectPtr create() const {
-        return std::make_shared<PythonObject>(*this);
+        return VMObjectPtr(new PythonObject(*this));
     }
 
     static VMObjectPtr create(VM* vm, PyObject* o) {
-        return std::make_shared<PythonObject>(vm, o);
+        return VMObjectPtr(new PythonObject(vm, o));
     }
 
     static VMObjectPtr create(VM* vm, const PyObject* o) {
@@ -268,7 +268,7 @@ public:
     }
 
     int compare(const VMObjectPtr& o) override {
-        auto v = (std::static_pointer_cast<PythonObject>(o))->value();
+        auto v = (vm_object_cast<PythonObject>(o))->value();
         // XXX: use python compare
         return false;
     }
@@ -286,7 +286,7 @@ public:
     }
 
     static PythonObjectPtr cast(const VMObjectPtr& o) {
-        return std::static_pointer_cast<PythonObject>(o);
+        return vm_object_cast<PythonObject>(o);
     }
 
     static CPythonObject value(const VMObjectPtr& o) {
@@ -164,6 +164,12 @@ public:
                 case OP_SET:
                 case OP_SPLIT:
                 case OP_ARRAY:
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_LT:
+                case OP_LE:
+                case OP_EQ:
                     write_op(os, fetch_op());
                     write_register(os, fetch_register());
                     write_register(os, fetch_register());
@@ -191,6 +197,17 @@ public:
                     write_op(os, fetch_op());
                     write_register(os, fetch_register());
                     break;
+                case OP_SWITCH: {
+                    write_op(os, fetch_op());
+                    write_register(os, fetch_register());
+                    auto n = fetch_index();
+                    write_index(os, n);
+                    write_label(os, fetch_label());
+                    for (int i = 0; i < n; i++) {
+                        write_i32(os, fetch_i32());
+                        write_label(os, fetch_label());
+                    }
+                } break;
             }
         }
 
@@ -25,18 +25,18 @@ public:
                 machine()->eval_line(s, main, exc);
             } catch (Error &e) {
                 auto s = e.message();
-                throw VMObjectText::create(s);
+                return machine()->raise(VMObjectText::create(s));
             }
 
             if (e != nullptr) {
-                throw e;
+                return machine()->raise(e);
             } else if (r != nullptr) {
                 return r;
             } else {
                 return nullptr;
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 
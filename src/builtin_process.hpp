@@ -2,17 +2,122 @@
 
 #include <stdlib.h>
 
+#include <atomic>
 #include <chrono>
 #include <mutex>
-#include <queue>
-#include <thread>
+#include <vector>
 
+#include "pool.hpp"
 #include "runtime.hpp"
 
 /**
  * Egel's process implementation.
+ *
+ * Processes are green threads multiplexed onto the shared worker pool. A
+ * process is SLEEPING, parked without a thread, while it has no message
+ * to handle, or no room to put its answer. Otherwise it becomes RUNNING
+ * and is scheduled as a pool task which works through its mailbox.
+ * HALTED is final.
+ *
+ * Mailboxes are lock-free and may be bounded. A sender blocks on a full
+ * mailbox, helping out the pool meanwhile, unless it uses try_send. A
+ * process with a full out mailbox parks until its answers are received.
  **/
 
+// a lock-free multi-producer single-consumer queue (after Vyukov), with an
+// optional bound on the number of messages
+class Mailbox {
+public:
+    explicit Mailbox(size_t capacity = 0) : _capacity(capacity) {
+    }
+
+    Mailbox(const Mailbox &) = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+
+    ~Mailbox() {
+        VMObjectPtr o;
+        while (pop(o)) {
+        }
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    bool bounded() const {
+        return _capacity > 0;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    bool full() const {
+        return bounded() && _size >= _capacity;
+    }
+
+    // any producer, false when full
+    bool push(const VMObjectPtr &o) {
+        auto n = _size.load();
+        do {
+            if (bounded() && n >= _capacity) return false;
+        } while (!_size.compare_exchange_weak(n, n + 1));
+        enqueue(new node_t(o));
+        return true;
+    }
+
+    // a producer which made sure there's room
+    void put(const VMObjectPtr &o) {
+        _size++;
+        enqueue(new node_t(o));
+    }
+
+    // the consumer, false when empty or while a push is still under way
+    bool pop(VMObjectPtr &o) {
+        auto tail = _tail;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (next == nullptr) return false;
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next == nullptr) {
+            if (tail != _head.load(std::memory_order_acquire)) return false;
+            enqueue(&_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) return false;
+        }
+        _tail = next;
+        o = std::move(tail->value);
+        delete tail;
+        _size--;
+        return true;
+    }
+
+private:
+    struct node_t {
+        node_t() = default;
+        explicit node_t(const VMObjectPtr &o) : value(o) {
+        }
+
+        std::atomic<node_t *> next = nullptr;
+        VMObjectPtr value;
+    };
+
+    void enqueue(node_t *n) {
+        n->next.store(nullptr, std::memory_order_relaxed);
+        auto prev = _head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    size_t _capacity;
+    std::atomic<size_t> _size = 0;
+    node_t _stub;
+    std::atomic<node_t *> _head = &_stub;
+    node_t *_tail = &_stub;
+};
+
 //## namespace System - process support
 
 //## System::process - opaque process object
@@ -20,22 +125,30 @@ class Process : public Opaque {
 public:
     OPAQUE_PREAMBLE(VM_SUB_BUILTIN, Process, "System", "process");
 
-    Process(VM *vm, const VMObjectPtr &f)
-        : Opaque(VM_SUB_BUILTIN, vm, "System", "process") {
+    // messages handled per turn before a process yields to others
+    static constexpr int BATCH = 64;
+
+    Process(VM *vm, const VMObjectPtr &f, size_t capacity = 0)
+        : Opaque(VM_SUB_BUILTIN, vm, "System", "process"),
+          _in(capacity),
+          _out(capacity) {
         _program = f;
         _exception = nullptr;
-        _state = RUNNING;
+        _state = SLEEPING;
     }
 
     Process(const Process &proc)
-        : Opaque(VM_SUB_BUILTIN, proc.machine(), proc.symbol()) {
+        : Opaque(VM_SUB_BUILTIN, proc.machine(), proc.symbol()),
+          _in(proc._in.capacity()),
+          _out(proc._out.capacity()) {
         _program = proc.program();
         _exception = nullptr;
-        _state = RUNNING;
+        _state = SLEEPING;
     }
 
-    static VMObjectPtr create(VM *vm, const VMObjectPtr &f) {
-        return std::make_shared<Process>(vm, f);
+    static VMObjectPtr create(VM *vm, const VMObjectPtr &f,
+                              size_t capacity = 0) {
+        return VMObjectPtr(new Process(vm, f, capacity));
     }
 
     int compare(const VMObjectPtr &o) override {
@@ -50,37 +163,43 @@ public:
         return _program;
     }
 
-    void in_push(const VMObjectPtr &o) {
-        _lock.lock();
-        _in_queue.push(o);
-        _lock.unlock();
+    // queue a message; on a full mailbox either help the pool until there's
+    // room, or return false; messages to a halted process are dropped
+    bool in_push(const VMObjectPtr &o, bool block) {
+        while (!_in.push(o)) {
+            if (!block) return false;
+            if (_state == HALTED) return true;
+            VMThreadPool::get().help(
+                [this] { return !_in.full() || (_state == HALTED); }, true);
+        }
+        wakeup();
+        return true;
     }
 
-    VMObjectPtr in_pop() {
-        VMObjectPtr o = nullptr;
-        _lock.lock();
-        if (!_in_queue.empty()) {
-            o = _in_queue.front();
-            _in_queue.pop();
-        }
-        _lock.unlock();
-        return o;
+    bool out_empty() const {
+        return _out.empty();
     }
 
-    void out_push(const VMObjectPtr &o) {
-        _lock.lock();
-        _out_queue.push(o);
-        _lock.unlock();
+    // false when there's no message
+    bool out_try_pop(VMObjectPtr &o) {
+        {
+            std::lock_guard<std::mutex> lock(_recv);
+            if (!_out.pop(o)) return false;
+        }
+        wakeup();  // the process may be parked on a full out mailbox
+        return true;
     }
 
-    VMObjectPtr out_pop() {
-        VMObjectPtr o = nullptr;
-        _lock.lock();
-        if (!_out_queue.empty()) {
-            o = _out_queue.front();
-            _out_queue.pop();
+    // helps the pool until a message arrives, nullptr once halted or when
+    // the deadline passes
+    VMObjectPtr out_pop(const VMThreadPool::time_point &deadline =
+                            VMThreadPool::time_point::max()) {
+        VMObjectPtr o;
+        while (!out_try_pop(o)) {
+            if ((_state == HALTED) && _out.empty()) return nullptr;
+            auto done = [this] { return !_out.empty() || (_state == HALTED); };
+            if (!VMThreadPool::get().help(done, true, deadline)) return nullptr;
         }
-        _lock.unlock();
         return o;
     }
 
@@ -88,10 +207,11 @@ public:
         return _state;
     }
 
-    void set_state(reducer_state_t s) {
-        if (_state != HALTED) {  // XXX: do I need to lock here?
-            _state = s;
-        }
+    // final, interrupts a running reduction and wakes everyone waiting
+    void halt() {
+        _state = HALTED;
+        _state.notify_all();
+        VMThreadPool::get().wake();
     }
 
     VMObjectPtr get_exception() {
@@ -107,63 +227,102 @@ public:
         _lock.unlock();
     }
 
-    void run() {
-        symbol_t tup = machine()->enter_symbol("System", "tuple");
+    // a message to handle and room for the answer
+    bool runnable() const {
+        return !_in.empty() && !_out.full();
+    }
 
-        _state = RUNNING;
-        VMObjectPtr in = nullptr;
+    // schedule the process if it's parked but runnable; the checks after
+    // every change on either side make sure a runnable process never stays
+    // parked
+    void wakeup() {
+        if (!runnable()) return;
+        auto s = SLEEPING;
+        if (_state.compare_exchange_strong(s, RUNNING)) schedule();
+    }
 
-        while (_state != HALTED) {
-            in = in_pop();
-            if (in == nullptr) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(25));
-            } else {
-                VMObjectPtrs thunk;
-                thunk.push_back(_program);
-                thunk.push_back(in);  // NOTE: _program and in are reduced
-                auto app = machine()->create_array(thunk);
+    // a pool task owns the process while it's RUNNING. nobody joins a
+    // process step, a program that throws out of the reducer halts it
+    void schedule() {
+        VMObjectPtr self(this);
+        VMThreadPool::get().submit(VMTask::create(
+            [self] {
+                auto p = vm_object_cast<Process>(self);
+                try {
+                    p->run();
+                } catch (...) {
+                    p->set_exception(VMObjectText::create("process failed"));
+                    p->halt();
+                }
+            },
+            true));
+    }
 
-                in = nullptr;
+    // handle a batch of messages, then park or reschedule
+    void run() {
+        for (int n = 0; n < BATCH; n++) {
+            if (_state == HALTED) return;
+            if (!runnable()) {
+                auto s = RUNNING;
+                if (!_state.compare_exchange_strong(s, SLEEPING)) return;
+                if (!runnable()) return;
+                s = SLEEPING;
+                if (!_state.compare_exchange_strong(s, RUNNING)) return;
+            }
+            VMObjectPtr in;
+            if (_in.pop(in)) {
+                if (_in.bounded()) VMThreadPool::get().wake();  // senders
+                step(in);
+            }
+        }
+        schedule();
+    }
+
+    void step(const VMObjectPtr &in) {
+        static VMSymbol tuple_symbol("System", "tuple");
+        symbol_t tup = tuple_symbol(machine());
+
+        VMObjectPtrs thunk;
+        thunk.push_back(_program);
+        thunk.push_back(in);  // NOTE: _program and in are reduced
+        auto app = machine()->create_array(thunk);
 
-                auto r = machine()->reduce(app, &_state);
+        auto r = machine()->reduce(app, &_state);
 
-                if (r.exception) {
-                    _exception = r.result;
-                    set_state(HALTED);
+        if (_state == HALTED) {
+            return;  // interrupted, or halted meanwhile
+        } else if (r.exception) {
+            set_exception(r.result);
+            halt();
+        } else {
+            auto t = r.result;
+            if (machine()->is_array(t)) {
+                auto ff = machine()->get_array(t);
+                if ((ff.size() == 3) && (ff[0]->symbol() == tup)) {
+                    _out.put(ff[1]);
+                    VMThreadPool::get().wake();  // receivers
+                    _program = ff[2];
                 } else {
-                    auto t = r.result;
-                    if (machine()->is_array(t)) {
-                        auto ff = machine()->get_array(t);
-                        if ((ff.size() == 3) && (ff[0]->symbol() == tup)) {
-                            out_push(ff[1]);
-                            _program = ff[2];
-                        } else {
-                            _exception = VMObjectText::create("no tuple");
-                            set_state(HALTED);
-                        }
-                    } else {
-                        _exception = VMObjectText::create("no tuple");
-                        set_state(HALTED);
-                    }
+                    set_exception(VMObjectText::create("no tuple"));
+                    halt();
                 }
+            } else {
+                set_exception(VMObjectText::create("no tuple"));
+                halt();
             }
         }
     }
 
 protected:
     VMObjectPtr _program;
-    std::queue<VMObjectPtr> _in_queue;
-    std::queue<VMObjectPtr> _out_queue;
+    Mailbox _in;
+    Mailbox _out;
     VMObjectPtr _exception;
     std::mutex _lock;
-    reducer_state_t _state;
+    std::mutex _recv;  // receivers take turns consuming the out mailbox
+    reducer_flag_t _state;
 };
 
-void run_process(const VMObjectPtr &o) {
-    auto process = std::static_pointer_cast<Process>(o);
-    process->run();
-}
-
 //## System::proc f - create a process object from f
 class Proc : public Monadic {
 public:
@@ -172,13 +331,28 @@ public:
     VMObjectPtr apply(const VMObjectPtr &arg0) const override {
         auto vm = machine();
 
-        auto proc = Process::create(vm, arg0);
+        VMObject::enter_concurrent();
+        return Process::create(vm, arg0);
+    }
+};
 
-        std::thread run(run_process, proc);
+//## System::proc_bounded n f - create a process object from f whose
+// mailboxes hold at most n messages each
+class ProcBounded : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, ProcBounded, "System", "proc_bounded");
 
-        run.detach();
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        if (machine()->is_integer(arg0) && machine()->get_integer(arg0) > 0) {
+            auto vm = machine();
+            auto n = machine()->get_integer(arg0);
 
-        return proc;
+            VMObject::enter_concurrent();
+            return Process::create(vm, arg1, n);
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
     }
 };
 
@@ -189,14 +363,35 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr &arg0,
                       const VMObjectPtr &arg1) const override {
-        symbol_t pr = machine()->enter_symbol("System", "process");
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
 
         if ((arg0->tag() == VM_OBJECT_OPAQUE) && (arg0->symbol() == pr)) {
-            auto process = std::static_pointer_cast<Process>(arg0);
-            process->in_push(arg1);
+            auto process = vm_object_cast<Process>(arg0);
+            process->in_push(arg1, true);
             return machine()->create_none();
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+    }
+};
+
+//## System::try_send proc msg - send message msg to proc, false when its
+// mailbox is full
+class TrySend : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, TrySend, "System", "try_send");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
+
+        if ((arg0->tag() == VM_OBJECT_OPAQUE) && (arg0->symbol() == pr)) {
+            auto process = vm_object_cast<Process>(arg0);
+            return machine()->create_bool(process->in_push(arg1, false));
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -207,17 +402,115 @@ public:
     MONADIC_PREAMBLE(VM_SUB_BUILTIN, Recv, "System", "recv");
 
     VMObjectPtr apply(const VMObjectPtr &arg0) const override {
-        symbol_t pr = machine()->enter_symbol("System", "process");
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
 
         if ((machine()->is_opaque(arg0)) && (arg0->symbol() == pr)) {
-            auto process = std::static_pointer_cast<Process>(arg0);
-            VMObjectPtr msg = nullptr;
-            while ((msg = process->out_pop()) == nullptr) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            auto process = vm_object_cast<Process>(arg0);
+            auto msg = process->out_pop();
+            if (msg == nullptr) {
+                // the process halted, raise its exception if it has one
+                auto e = process->get_exception();
+                if (e == nullptr) e = machine()->create_text("halted");
+                return machine()->raise(e);
             }
             return msg;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+//## System::recv_timeout proc ms - receive a message from process proc,
+// 'none' when there's none within ms milliseconds
+class RecvTimeout : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, RecvTimeout, "System", "recv_timeout");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == pr) &&
+            machine()->is_integer(arg1) && machine()->get_integer(arg1) >= 0) {
+            auto process = vm_object_cast<Process>(arg0);
+            auto ms = std::chrono::milliseconds(machine()->get_integer(arg1));
+            auto deadline = std::chrono::steady_clock::now() + ms;
+            auto msg = process->out_pop(deadline);
+            if (msg != nullptr) return msg;
+            if (process->get_state() == HALTED) {
+                auto e = process->get_exception();
+                if (e == nullptr) e = machine()->create_text("halted");
+                return machine()->raise(e);
+            }
+            return machine()->create_none();
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+    }
+};
+
+//## System::select {p0, p1, ..} ms - receive the first message from any of
+// the processes as a tuple (p, msg), 'none' when there's none within ms
+// milliseconds
+class Select : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, Select, "System", "select");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
+
+        if (!machine()->is_list(arg0) || !machine()->is_integer(arg1) ||
+            machine()->get_integer(arg1) < 0) {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+
+        auto pp = machine()->from_list(arg0);
+        std::vector<Process *> processes;
+        for (auto &p : pp) {
+            if ((machine()->is_opaque(p)) && (p->symbol() == pr)) {
+                processes.push_back(vm_object_cast<Process>(p).get());
+            } else {
+                return machine()->raise(machine()->bad_args(this, arg0, arg1));
+            }
+        }
+
+        auto ms = std::chrono::milliseconds(machine()->get_integer(arg1));
+        auto deadline = std::chrono::steady_clock::now() + ms;
+
+        // nothing can arrive, help other processes until the timeout
+        if (processes.empty()) {
+            VMThreadPool::get().help([] { return false; }, true, deadline);
+            return machine()->create_none();
+        }
+
+        auto done = [&processes] {
+            bool halted = true;
+            for (auto p : processes) {
+                if (!p->out_empty()) return true;
+                halted = halted && (p->get_state() == HALTED);
+            }
+            return halted;
+        };
+
+        while (true) {
+            VMObjectPtr msg;
+            bool halted = true;
+            for (size_t i = 0; i < processes.size(); i++) {
+                if (processes[i]->out_try_pop(msg)) {
+                    return machine()->to_tuple({pp[i], msg});
+                }
+                halted = halted && (processes[i]->get_state() == HALTED);
+            }
+            if (halted) {
+                return machine()->raise(machine()->create_text("halted"));
+            }
+            if (!VMThreadPool::get().help(done, true, deadline)) {
+                return machine()->create_none();
+            }
         }
     }
 };
@@ -228,14 +521,222 @@ public:
     MONADIC_PREAMBLE(VM_SUB_BUILTIN, Halt, "System", "halt");
 
     VMObjectPtr apply(const VMObjectPtr &arg0) const override {
-        symbol_t pr = machine()->enter_symbol("System", "process");
+        static VMSymbol process_symbol("System", "process");
+        symbol_t pr = process_symbol(machine());
 
         if ((machine()->is_opaque(arg0)) && (arg0->symbol() == pr)) {
-            auto process = std::static_pointer_cast<Process>(arg0);
-            process->set_state(HALTED);
+            auto process = vm_object_cast<Process>(arg0);
+            process->halt();
             return machine()->create_none();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+/**
+ * Channels stream values between reducers, e.g. par or async
+ * computations, without the request/answer protocol of processes.
+ *
+ * A channel is a bounded lock-free multi-producer multi-consumer ring
+ * (after Vyukov). Blocking puts and takes wait like mailboxes do: they
+ * help with process steps, and while every thread is busy the pool adds a
+ * spare worker for the tasks they can't run, e.g. the other side of a par.
+ * Past the par nesting threshold branches are reduced in order, so a
+ * producer and a consumer there are better started with async.
+ **/
+
+//## System::chan - opaque channel object
+class Channel : public Opaque {
+public:
+    OPAQUE_PREAMBLE(VM_SUB_BUILTIN, Channel, "System", "chan");
+
+    // the cells are allocated up front
+    static constexpr size_t MAX_CAPACITY = size_t(1) << 20;
+
+    Channel(VM *vm, size_t capacity)
+        : Opaque(VM_SUB_BUILTIN, vm, "System", "chan"), _cells(capacity) {
+        for (size_t i = 0; i < capacity; i++) {
+            _cells[i].sequence = i;
+        }
+    }
+
+    Channel(const Channel &ch)
+        : Channel(ch.machine(), ch.capacity()) {
+    }
+
+    static VMObjectPtr create(VM *vm, size_t capacity) {
+        return VMObjectPtr(new Channel(vm, capacity));
+    }
+
+    int compare(const VMObjectPtr &o) override {
+        return -1;  // XXX: fix this once
+    }
+
+    size_t capacity() const {
+        return _cells.size();
+    }
+
+    bool empty() const {
+        return _tail == _head;
+    }
+
+    bool full() const {
+        return _tail - _head >= capacity();
+    }
+
+    // false when full
+    bool try_put(const VMObjectPtr &o) {
+        auto n = capacity();
+        auto pos = _tail.load(std::memory_order_relaxed);
+        cell_t *cell;
+        while (true) {
+            cell = &_cells[pos % n];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = o;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        VMThreadPool::get().wake();
+        return true;
+    }
+
+    // false when empty
+    bool try_take(VMObjectPtr &o) {
+        auto n = capacity();
+        auto pos = _head.load(std::memory_order_relaxed);
+        cell_t *cell;
+        while (true) {
+            cell = &_cells[pos % n];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+        o = std::move(cell->value);
+        cell->sequence.store(pos + n, std::memory_order_release);
+        VMThreadPool::get().wake();
+        return true;
+    }
+
+    // helps the pool with process steps until there's room
+    void put(const VMObjectPtr &o) {
+        while (!try_put(o)) {
+            VMThreadPool::get().help([this] { return !full(); }, true);
+        }
+    }
+
+    // helps the pool with process steps until there's a value
+    VMObjectPtr take() {
+        VMObjectPtr o;
+        while (!try_take(o)) {
+            VMThreadPool::get().help([this] { return !empty(); }, true);
+        }
+        return o;
+    }
+
+private:
+    struct cell_t {
+        std::atomic<size_t> sequence;
+        VMObjectPtr value;
+    };
+
+    std::vector<cell_t> _cells;
+    alignas(64) std::atomic<size_t> _tail = 0;
+    alignas(64) std::atomic<size_t> _head = 0;
+};
+
+//## System::channel n - create a channel holding at most n values, n is at
+// most 1048576
+class MakeChannel : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, MakeChannel, "System", "channel");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        if (machine()->is_integer(arg0) && machine()->get_integer(arg0) > 0 &&
+            machine()->get_integer(arg0) <= (vm_int_t)Channel::MAX_CAPACITY) {
+            VMObject::enter_concurrent();
+            return Channel::create(machine(), machine()->get_integer(arg0));
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+//## System::chan_put ch x - put x on channel ch, blocks while it's full
+class ChanPut : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, ChanPut, "System", "chan_put");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol chan_symbol("System", "chan");
+        symbol_t sym = chan_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            vm_object_cast<Channel>(arg0)->put(arg1);
+            return machine()->create_none();
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+    }
+};
+
+//## System::chan_take ch - take a value from channel ch, blocks while it's
+// empty
+class ChanTake : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, ChanTake, "System", "chan_take");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        static VMSymbol chan_symbol("System", "chan");
+        symbol_t sym = chan_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            return vm_object_cast<Channel>(arg0)->take();
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+//## System::chan_try_take ch - take a value from channel ch, 'none' when
+// it's empty
+class ChanTryTake : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, ChanTryTake, "System", "chan_try_take");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        static VMSymbol chan_symbol("System", "chan");
+        symbol_t sym = chan_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            VMObjectPtr o;
+            if (vm_object_cast<Channel>(arg0)->try_take(o)) {
+                return o;
+            } else {
+                return machine()->create_none();
+            }
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -248,9 +749,18 @@ inline std::vector<VMObjectPtr> builtin_process(VM *vm) {
     oo.push_back(VMObjectStub::create(
         vm, "System::process"));  // XXX: I always forget whether this is needed
     oo.push_back(Proc::create(vm));
+    oo.push_back(ProcBounded::create(vm));
     oo.push_back(Send::create(vm));
+    oo.push_back(TrySend::create(vm));
     oo.push_back(Recv::create(vm));
+    oo.push_back(RecvTimeout::create(vm));
+    oo.push_back(Select::create(vm));
     oo.push_back(Halt::create(vm));
+    oo.push_back(VMObjectStub::create(vm, "System::chan"));
+    oo.push_back(MakeChannel::create(vm));
+    oo.push_back(ChanPut::create(vm));
+    oo.push_back(ChanTake::create(vm));
+    oo.push_back(ChanTryTake::create(vm));
 
     return oo;
 }
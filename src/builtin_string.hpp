@@ -23,7 +23,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 == s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -40,7 +40,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 != s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -57,7 +57,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 > s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -74,7 +74,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 < s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -91,7 +91,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 >= s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -108,7 +108,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s0 <= s1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -126,7 +126,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_integer(s0.compare(s1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -145,7 +145,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_integer(s0.compareCodePointOrder(s1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -164,7 +164,7 @@ public:
             return machine()->create_integer(
                 s0.caseCompare(s1, U_FOLD_CASE_DEFAULT));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -182,7 +182,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s1.startsWith(s0));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -200,7 +200,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_bool(s1.endsWith(s0));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -218,7 +218,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_integer(s1.indexOf(s0));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -236,7 +236,7 @@ public:
             auto s1 = machine()->get_text(arg1);
             return machine()->create_integer(s1.lastIndexOf(s0));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -254,7 +254,7 @@ public:
             auto s = machine()->get_text(arg1);
             return machine()->create_char(s.char32At(n));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -274,7 +274,8 @@ public:
             auto s = machine()->get_text(arg2);
             return machine()->create_integer(s.moveIndex32(n, d));
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -289,7 +290,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_integer(s.countChar32());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -304,7 +305,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_bool(s.isEmpty());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -319,7 +320,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_integer(s.hashCode());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -334,7 +335,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_bool(s.isBogus());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -355,7 +356,7 @@ public:
             auto c = machine()->get_char(arg1);
             return machine()->create_text(s0.append(c));
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -375,7 +376,8 @@ public:
             auto s1 = machine()->get_text(arg2);
             return machine()->create_text(s1.insert(n, s0));
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -395,7 +397,8 @@ public:
             auto s2 = machine()->get_text(arg2);
             return machine()->create_text(s2.findAndReplace(s0, s1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -415,7 +418,8 @@ public:
             auto s0 = machine()->get_text(arg2);
             return machine()->create_text(s0.removeBetween(n0, n1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -435,7 +439,8 @@ public:
             auto s0 = machine()->get_text(arg2);
             return machine()->create_text(s0.retainBetween(n0, n1));
         } else {
-            throw machine()->bad_args(this, arg0, arg1, arg2);
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
         }
     }
 };
@@ -450,7 +455,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.trim());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -465,7 +470,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.reverse());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -481,7 +486,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.toUpper());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -497,7 +502,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.toLower());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -512,7 +517,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.foldCase());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -528,7 +533,7 @@ public:
             auto s = machine()->get_text(arg0);
             return machine()->create_text(s.unescape());
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -543,7 +548,7 @@ public:
             auto c = machine()->get_char(arg0);
             return machine()->create_integer(c);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -558,7 +563,7 @@ public:
             auto n = machine()->get_integer(arg0);
             return machine()->create_char(n);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -4,8 +4,10 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include <atomic>
 #include <iostream>
 #include <map>
+#include <thread>
 #if __has_include(<fmt/args.h>)
 #include <fmt/args.h>
 #endif
@@ -102,7 +104,7 @@ public:
             auto i = machine()->get_integer(arg0);
             vm_int_t res;
             if (mul_overflow((vm_int_t)-1, i, &res)) {
-                throw machine()->bad(this, "overflow");
+                return machine()->raise(machine()->bad(this, "overflow"));
             } else {
                 return machine()->create_integer(res);
             }
@@ -110,7 +112,7 @@ public:
             auto f = machine()->get_float(arg0);
             return machine()->create_float(-f);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -127,7 +129,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             vm_int_t res;
             if (add_overflow(i0, i1, &res)) {
-                throw machine()->bad(this, "overflow");
+                return machine()->raise(machine()->bad(this, "overflow"));
             } else {
                 return machine()->create_integer(res);
             }
@@ -140,7 +142,7 @@ public:
             auto f1 = machine()->get_text(arg1);
             return VMObjectText::create(f0 + f1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -157,7 +159,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             vm_int_t res;
             if (sub_overflow(i0, i1, &res)) {
-                throw machine()->bad(this, "overflow");
+                return machine()->raise(machine()->bad(this, "overflow"));
             } else {
                 return machine()->create_integer(res);
             }
@@ -166,7 +168,7 @@ public:
             auto f1 = machine()->get_float(arg1);
             return machine()->create_float(f0 - f1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -183,7 +185,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             vm_int_t res;
             if (mul_overflow(i0, i1, &res)) {
-                throw machine()->bad(this, "overflow");
+                return machine()->raise(machine()->bad(this, "overflow"));
             } else {
                 return machine()->create_integer(res);
             }
@@ -192,7 +194,7 @@ public:
             auto f1 = machine()->get_float(arg1);
             return machine()->create_float(f0 * f1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -208,18 +210,18 @@ public:
             auto i0 = machine()->get_integer(arg0);
             auto i1 = machine()->get_integer(arg1);
             if (i1 == 0) {
-                throw machine()->bad(this, "divide by zero");
+                return machine()->raise(machine()->bad(this, "divide by zero"));
             }
             return machine()->create_integer(i0 / i1);
         } else if ((machine()->is_float(arg0)) && (machine()->is_float(arg1))) {
             auto f0 = machine()->get_float(arg0);
             auto f1 = machine()->get_float(arg1);
             if (f1 == 0.0) {
-                throw machine()->bad(this, "divide by zero");
+                return machine()->raise(machine()->bad(this, "divide by zero"));
             }
             return machine()->create_float(f0 / f1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -235,11 +237,11 @@ public:
             auto i0 = machine()->get_integer(arg0);
             auto i1 = machine()->get_integer(arg1);
             if (i1 == 0) {
-                throw machine()->bad(this, "divide by zero");
+                return machine()->raise(machine()->bad(this, "divide by zero"));
             }
             return machine()->create_integer(i0 % i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -256,7 +258,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             return machine()->create_integer(i0 & i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -273,7 +275,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             return machine()->create_integer(i0 | i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -290,7 +292,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             return machine()->create_integer(i0 ^ i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -305,7 +307,7 @@ public:
             auto i0 = machine()->get_integer(arg0);
             return machine()->create_integer(~i0);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -322,7 +324,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             return machine()->create_integer(i0 << i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -339,7 +341,7 @@ public:
             auto i1 = machine()->get_integer(arg1);
             return machine()->create_integer(i0 >> i1);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -415,8 +417,8 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr &arg0,
                       const VMObjectPtr &arg1) const override {
-        static symbol_t object = 0;
-        if (object == 0) object = machine()->enter_symbol("System", "object");
+        static VMSymbol object_symbol("System", "object");
+        symbol_t object = object_symbol(machine());
 
         if (machine()->is_array(arg1)) {
             auto ff = machine()->get_array(arg1);
@@ -434,10 +436,10 @@ public:
             if ((n + 1) < sz) {
                 return ff[n + 1];
             } else {
-                throw machine()->bad(this, "invalid");
+                return machine()->raise(machine()->bad(this, "invalid"));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -449,8 +451,8 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr &arg0, const VMObjectPtr &arg1,
                       const VMObjectPtr &arg2) const override {
-        static symbol_t object = 0;
-        if (object == 0) object = machine()->enter_symbol("System", "object");
+        static VMSymbol object_symbol("System", "object");
+        symbol_t object = object_symbol(machine());
 
         if (machine()->is_array(arg2)) {
             auto ff = machine()->get_array(arg2);
@@ -472,10 +474,10 @@ public:
                 arr->set(n + 1, arg1);
                 return arg0;
             } else {
-                throw machine()->bad(this, "invalid");
+                return machine()->raise(machine()->bad(this, "invalid"));
             }
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -519,7 +521,7 @@ public:
 
             return machine()->create_array(oo);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -544,7 +546,7 @@ public:
             auto i = convert_to_int(s);
             return machine()->create_integer(i);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -565,7 +567,7 @@ public:
             auto i = convert_to_float(s);
             return machine()->create_float(i);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -591,7 +593,7 @@ public:
         } else if (machine()->is_text(arg0)) {
             return arg0;
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -649,13 +651,14 @@ public:
     UNARY_PREAMBLE(VM_SUB_BUILTIN, Getref, "System", "get_ref");
 
     VMObjectPtr apply(const VMObjectPtr &arg0) const override {
-        symbol_t sym = machine()->enter_symbol("System", "reference");
+        static VMSymbol reference_symbol("System", "reference");
+        symbol_t sym = reference_symbol(machine());
 
         if ((arg0->tag() == VM_OBJECT_OPAQUE) && (arg0->symbol() == sym)) {
-            auto r = std::static_pointer_cast<Reference>(arg0);
+            auto r = vm_object_cast<Reference>(arg0);
             return r->get_ref();
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -667,14 +670,180 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr &arg0,
                       const VMObjectPtr &arg1) const override {
-        symbol_t sym = machine()->enter_symbol("System", "reference");
+        static VMSymbol reference_symbol("System", "reference");
+        symbol_t sym = reference_symbol(machine());
 
         if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
-            auto r = std::static_pointer_cast<Reference>(arg0);
+            auto r = vm_object_cast<Reference>(arg0);
             r->set_ref(arg1);
             return arg0;
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+    }
+};
+
+//## System::atomic_reference - an opaque atomic reference object
+class AtomicReference : public Opaque {
+public:
+    OPAQUE_PREAMBLE(VM_SUB_BUILTIN, AtomicReference, "System",
+                    "atomic_reference");
+
+    AtomicReference(VM *vm, const VMObjectPtr &r)
+        : Opaque(VM_SUB_BUILTIN, vm, "System", "atomic_reference") {
+        _value = r;
+    }
+
+    AtomicReference(const AtomicReference &ref)
+        : AtomicReference(ref.machine(), ref.load()) {
+    }
+
+    static VMObjectPtr create(VM *vm, const VMObjectPtr &r) {
+        return VMObjectPtr(new AtomicReference(vm, r));
+    }
+
+    int compare(const VMObjectPtr &o) override {
+        return -1;  // XXX: fix this once
+    }
+
+    VMObjectPtr load() const {
+        lock();
+        auto v = _value;
+        unlock();
+        return v;
+    }
+
+    // the old value is released by the caller, outside of the lock
+    VMObjectPtr exchange(const VMObjectPtr &v) {
+        auto n = v;
+        lock();
+        std::swap(_value, n);
+        unlock();
+        return n;
+    }
+
+    // set to 'desired' when the value is 'expected'; by identity, or by
+    // structural equality
+    bool compare_exchange(const VMObjectPtr &expected,
+                          const VMObjectPtr &desired, bool structural) {
+        CompareVMObjectPtr compare;
+        auto n = desired;
+        lock();
+        bool eq = structural ? (compare(_value, expected) == 0)
+                             : (_value == expected);
+        if (eq) std::swap(_value, n);
+        unlock();
+        return eq;
+    }
+
+private:
+    // intrusive counts can't be read and retained in one atomic step, a
+    // spinlock guards the slot; like std::atomic<std::shared_ptr> does
+    void lock() const {
+        while (_lock.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() const {
+        _lock.clear(std::memory_order_release);
+    }
+
+    mutable std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+    VMObjectPtr _value = nullptr;
+};
+
+//## System::atomic x - create an atomic reference object holding x
+class Atomic : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, Atomic, "System", "atomic");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        VMObject::enter_concurrent();
+        return AtomicReference::create(machine(), arg0);
+    }
+};
+
+//## System::atomic_get a - get the value of atomic reference a
+class AtomicGet : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, AtomicGet, "System", "atomic_get");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        static VMSymbol atomic_reference_symbol("System", "atomic_reference");
+        symbol_t sym = atomic_reference_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            return vm_object_cast<AtomicReference>(arg0)->load();
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+//## System::atomic_swap a x - set atomic reference a to x, returns the old
+// value
+class AtomicSwap : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, AtomicSwap, "System", "atomic_swap");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol atomic_reference_symbol("System", "atomic_reference");
+        symbol_t sym = atomic_reference_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            return vm_object_cast<AtomicReference>(arg0)->exchange(arg1);
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+    }
+};
+
+//## System::atomic_cas a x y - set atomic reference a to y if it equals x,
+// returns whether it did
+class AtomicCas : public Triadic {
+public:
+    TRIADIC_PREAMBLE(VM_SUB_BUILTIN, AtomicCas, "System", "atomic_cas");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0, const VMObjectPtr &arg1,
+                      const VMObjectPtr &arg2) const override {
+        static VMSymbol atomic_reference_symbol("System", "atomic_reference");
+        symbol_t sym = atomic_reference_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            auto a = vm_object_cast<AtomicReference>(arg0);
+            auto b = a->compare_exchange(arg1, arg2, true);
+            return machine()->create_bool(b);
+        } else {
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
+        }
+    }
+};
+
+//## System::atomic_update a f - atomically set atomic reference a to 'f x'
+// for its value x, retries when raced; returns the new value
+class AtomicUpdate : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, AtomicUpdate, "System", "atomic_update");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        static VMSymbol atomic_reference_symbol("System", "atomic_reference");
+        symbol_t sym = atomic_reference_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            auto a = vm_object_cast<AtomicReference>(arg0);
+            while (true) {
+                auto x = a->load();
+                VMObjectPtr t[] = {arg1, x};
+                auto r = machine()->reduce(VMObjectArray::create(t, 2));
+                if (r.exception) return machine()->raise(r.result);
+                if (a->compare_exchange(x, r.result, false)) return r.result;
+            }
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -696,7 +865,7 @@ public:
             }
             return machine()->to_list(ss);
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -707,11 +876,8 @@ public:
     MONADIC_PREAMBLE(VM_SUB_BUILTIN, Pack, "System", "pack");
 
     VMObjectPtr apply(const VMObjectPtr &arg0) const override {
-        static symbol_t _nil = 0;
-        if (_nil == 0) _nil = machine()->enter_symbol("System", "nil");
-
-        static symbol_t _cons = 0;
-        if (_cons == 0) _cons = machine()->enter_symbol("System", "cons");
+        static VMSymbol cons_symbol("System", "cons");
+        symbol_t _cons = cons_symbol(machine());
 
         icu::UnicodeString ss;
         auto a = arg0;
@@ -749,7 +915,7 @@ public:
                 return none;
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -773,7 +939,7 @@ public:
                 return none;
             }
         } else {
-            throw machine()->bad_args(this, arg0);
+            return machine()->raise(machine()->bad_args(this, arg0));
         }
     }
 };
@@ -795,7 +961,7 @@ public:
             thunk.push_back(machine()->create_none());
             return machine()->create_array(thunk);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -817,7 +983,7 @@ public:
             thunk.push_back(machine()->create_none());
             return machine()->create_array(thunk);
         } else {
-            throw machine()->bad_args(this, arg0, arg1);
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
         }
     }
 };
@@ -827,7 +993,7 @@ class Print : public Variadic {
 public:
     VARIADIC_PREAMBLE(VM_SUB_BUILTIN, Print, "System", "print");
 
-    VMObjectPtr apply(const VMObjectPtrs &args) const override {
+    VMObjectPtr apply(const VMObjectPtrView &args) const override {
         icu::UnicodeString s;
         for (auto &arg : args) {
             if (machine()->is_integer(arg)) {
@@ -867,7 +1033,7 @@ class Format : public Variadic {
 public:
     VARIADIC_PREAMBLE(VM_SUB_BUILTIN, Format, "System", "format");
 
-    VMObjectPtr apply(const VMObjectPtrs &args) const override {
+    VMObjectPtr apply(const VMObjectPtrView &args) const override {
         if (args.size() < 1) {
             return nullptr;
         } else {
@@ -909,19 +1075,47 @@ public:
                 try {
                     r = fmt::vformat(fmt, store);
                 } catch (std::runtime_error &e) {
-                    throw machine()->bad(this, "invalid");
+                    return machine()->raise(machine()->bad(this, "invalid"));
                 }
                 auto u = icu::UnicodeString(r.c_str());
                 delete fmt;
 
                 return VMObjectText::create(u);
             } else {
-                throw machine()->bad(this, "format");
+                return machine()->raise(machine()->bad(this, "format"));
             }
         }
     }
 };
 
+//## System::frame_stats - reused and freshly allocated array frames, a
+// measure of how well the frame cache works
+class FrameStats : public Medadic {
+public:
+    MEDADIC_PREAMBLE(VM_SUB_BUILTIN, FrameStats, "System", "frame_stats");
+
+    VMObjectPtr apply() const override {
+        auto s = VMFrameCache::stats();
+        VMObjectPtrs oo;
+        oo.push_back(machine()->create_integer(s.reused));
+        oo.push_back(machine()->create_integer(s.allocated));
+        return machine()->to_tuple(oo);
+    }
+};
+
+//## System::stats - reduction statistics as a json text; nothing is
+// counted unless egel runs with -S or -P
+class Stats : public Medadic {
+public:
+    MEDADIC_PREAMBLE(VM_SUB_BUILTIN, Stats, "System", "stats");
+
+    VMObjectPtr apply() const override {
+        std::stringstream ss;
+        VMStats::render(ss, machine());
+        return machine()->create_text(icu::UnicodeString::fromUTF8(ss.str()));
+    }
+};
+
 inline std::vector<VMObjectPtr> builtin_system(VM *vm) {
     std::vector<VMObjectPtr> oo;
 
@@ -983,6 +1177,8 @@ inline std::vector<VMObjectPtr> builtin_system(VM *vm) {
     // system info, override if sandboxed
     oo.push_back(Arg::create(vm));
     oo.push_back(Getenv::create(vm));
+    oo.push_back(FrameStats::create(vm));
+    oo.push_back(Stats::create(vm));
 
     // the builtin print & getline, override if sandboxed
     oo.push_back(Print::create(vm));
@@ -996,6 +1192,14 @@ inline std::vector<VMObjectPtr> builtin_system(VM *vm) {
     oo.push_back(Setref::create(vm));
     oo.push_back(Getref::create(vm));
 
+    // atomic references
+    oo.push_back(VMObjectStub::create(vm, "System::atomic_reference"));
+    oo.push_back(Atomic::create(vm));
+    oo.push_back(AtomicGet::create(vm));
+    oo.push_back(AtomicSwap::create(vm));
+    oo.push_back(AtomicCas::create(vm));
+    oo.push_back(AtomicUpdate::create(vm));
+
     // OO fields
     oo.push_back(GetField::create(vm));
     oo.push_back(SetField::create(vm));
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 
-#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
 
+#include "pool.hpp"
 #include "runtime.hpp"
 
 /**
@@ -14,13 +19,16 @@
  * It's a simplistic construct which doesn't handle exception handling
  *well. I.e., when a thread throws an exception it places it in the
  *resulting tuple; the other thread is allowed to continue to run.
+ *
+ * The right computation is handed to the shared work-stealing pool while
+ * the caller reduces the left one, then helps out until the right one is
+ * done. When the pool is saturated, or par is nested deeper than the
+ * threshold, both sides are simply reduced in order on the caller.
+ *
+ * par_map, par_all and par_reduce generalize this to lists and tuples,
+ * async and await schedule a single computation on the same pool.
  **/
 
-void runthread(VM *vm, const VMObjectPtr &e, const VMObjectPtr &ret,
-               const VMObjectPtr &exc) {
-    vm->reduce(e, ret, exc);
-}
-
 class VMObjectThreadResult : public VMObjectCombinator {
 public:
     VMObjectThreadResult(VM *m, const symbol_t s, const VMObjectPtr &tuple,
@@ -33,11 +41,11 @@ public:
 
     static VMObjectPtr create(VM *m, const symbol_t s, const VMObjectPtr &tuple,
                               int pos) {
-        return std::make_shared<VMObjectThreadResult>(m, s, tuple, pos);
+        return VMObjectPtr(new VMObjectThreadResult(m, s, tuple, pos));
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = machine()->get_array(thunk);
+        auto tt = machine()->array_view(thunk);
         auto arg0 = tt[5];
 
         auto t = VM_OBJECT_ARRAY_CAST(_tuple);
@@ -63,11 +71,11 @@ public:
 
     static VMObjectPtr create(VM *vm, const symbol_t s,
                               const VMObjectPtr &tuple, int pos) {
-        return std::make_shared<VMObjectThreadException>(vm, s, tuple, pos);
+        return VMObjectPtr(new VMObjectThreadException(vm, s, tuple, pos));
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = machine()->get_array(thunk);
+        auto tt = machine()->array_view(thunk);
         auto arg0 = tt[5];
 
         auto t = VM_OBJECT_ARRAY_CAST(_tuple);
@@ -81,6 +89,80 @@ protected:
     int _pos;
 };
 
+/**
+ * Forks jobs onto the pool. Nested forks track their depth per thread;
+ * past the threshold the jobs are run in order on the caller instead. When
+ * the pool is saturated the jobs are kept back and run in order on the
+ * caller too, unless the caller has to wait on a channel, a mailbox or a
+ * task first; then the pool gets them after all.
+ **/
+class ParFork {
+public:
+    // run 'job(0)' .. 'job(n-1)', the caller runs 'job(0)' itself. the
+    // forked jobs refer to 'job', so all are joined before the exception
+    // of the leftmost job that threw is rethrown
+    static void run(size_t n, const std::function<void(size_t)> &job) {
+        auto &pool = VMThreadPool::get();
+
+        auto depth = _depth;
+        _depth = depth + 1;
+        std::vector<VMTaskPtr> tasks;
+        bool defer = pool.saturated();
+        if (n > 1 && depth < _threshold) {
+            VMObject::enter_concurrent();
+            for (size_t i = 1; i < n; i++) {
+                tasks.push_back(VMTask::create([&job, i, depth] {
+                    auto d = _depth;
+                    _depth = depth + 1;
+                    try {
+                        job(i);
+                    } catch (...) {
+                        _depth = d;
+                        throw;
+                    }
+                    _depth = d;
+                }));
+                if (defer) {
+                    pool.defer(tasks.back());
+                } else {
+                    pool.submit(tasks.back());
+                }
+            }
+        }
+        std::exception_ptr error;
+        try {
+            job(0);
+            for (size_t i = tasks.size() + 1; i < n; i++) {
+                job(i);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (auto &t : tasks) {
+            try {
+                if (pool.recall(t)) {
+                    if (error != nullptr) continue;
+                    t->run();
+                }
+                pool.join(t);
+            } catch (...) {
+                if (error == nullptr) error = std::current_exception();
+            }
+        }
+        _depth = depth;
+        if (error != nullptr) std::rethrow_exception(error);
+    }
+
+    // beyond this many nested forks jobs are run sequentially
+    static int threshold(int n) {
+        return _threshold.exchange(n);
+    }
+
+private:
+    static inline std::atomic<int> _threshold = 16;
+    static inline thread_local int _depth = 0;
+};
+
 //## System::par f g - concurrently evaluate 'f none' and 'g none'
 class Par : public Dyadic {
 public:
@@ -88,8 +170,8 @@ public:
 
     VMObjectPtr apply(const VMObjectPtr &arg0,
                       const VMObjectPtr &arg1) const override {
-        static symbol_t sym = 0;
-        if (sym == 0) sym = machine()->enter_symbol("System", "thread");
+        static VMSymbol thread_symbol("System", "thread");
+        symbol_t sym = thread_symbol(machine());
 
         auto tuple = machine()->create_tuple();
         auto none = machine()->create_none();
@@ -111,26 +193,332 @@ public:
         auto right = VMObjectArray::create(rr);
 
         auto vm = machine();
+        VMObjectPtr thunks[] = {left, right};
 
-        std::thread first(runthread, vm, left,
-                          VMObjectThreadResult::create(vm, sym, result, 1),
-                          VMObjectThreadException::create(vm, sym, result, 1));
-        std::thread second(runthread, vm, right,
-                           VMObjectThreadResult::create(vm, sym, result, 2),
-                           VMObjectThreadException::create(vm, sym, result, 2));
-
-        first.join();
-        second.join();
+        ParFork::run(2, [vm, sym, &thunks, &result](size_t i) {
+            vm->reduce(thunks[i],
+                       VMObjectThreadResult::create(vm, sym, result, i + 1),
+                       VMObjectThreadException::create(vm, sym, result, i + 1));
+        });
 
         return result;
     }
 };
 
+//## System::par_threshold n - set the par nesting depth after which 'par'
+// evaluates sequentially, returns the previous threshold
+class ParThreshold : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, ParThreshold, "System", "par_threshold");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        if (machine()->is_integer(arg0) && machine()->get_integer(arg0) >= 0) {
+            auto n = machine()->get_integer(arg0);
+            n = ParFork::threshold(n > INT_MAX ? INT_MAX : n);
+            return machine()->create_integer(n);
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+/**
+ * The n-ary combinators split their work in a few chunks per worker and
+ * keep the order of the input. An exception is propagated as sequential
+ * evaluation would: the one of the leftmost failing element wins, and
+ * elements to the right of a failure are skipped where possible.
+ **/
+
+// the elements of a list or tuple
+inline bool par_elements(VM *vm, const VMObjectPtr &o, VMObjectPtrs &xx,
+                         bool &tuple) {
+    if (vm->is_list(o)) {
+        xx = vm->from_list(o);
+        tuple = false;
+        return true;
+    } else if (vm->is_array(o) && vm->is_tuple(vm->array_get(o, 0))) {
+        auto tt = vm->array_view(o).subspan(1);
+        xx.assign(tt.begin(), tt.end());
+        tuple = true;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+inline size_t par_chunks(size_t n) {
+    return std::min(n, 4 * VMThreadPool::workers());
+}
+
+// lower 'failed' to 'i'
+inline void par_failed(std::atomic<size_t> &failed, size_t i) {
+    auto f = failed.load();
+    while (i < f && !failed.compare_exchange_weak(f, i)) {
+    }
+}
+
+// reduce all thunks, returns the index of the leftmost exception in 'rr'
+// or the number of thunks
+inline size_t par_reduce_all(VM *vm, const VMObjectPtrs &tt,
+                             VMObjectPtrs &rr) {
+    auto n = tt.size();
+    rr.assign(n, nullptr);
+    if (n == 0) return 0;
+
+    std::atomic<size_t> failed = n;
+    auto chunks = par_chunks(n);
+    ParFork::run(chunks, [vm, &tt, &rr, &failed, n, chunks](size_t c) {
+        for (size_t i = c * n / chunks; i < (c + 1) * n / chunks; i++) {
+            if (i > failed.load(std::memory_order_relaxed)) return;
+            auto r = vm->reduce(tt[i]);
+            rr[i] = r.result;
+            if (r.exception) {
+                par_failed(failed, i);
+                return;
+            }
+        }
+    });
+    return failed;
+}
+
+//## System::par_map f xs - concurrently map 'f' over a list or tuple
+class ParMap : public Dyadic {
+public:
+    DYADIC_PREAMBLE(VM_SUB_BUILTIN, ParMap, "System", "par_map");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0,
+                      const VMObjectPtr &arg1) const override {
+        VMObjectPtrs xx;
+        bool tuple;
+        if (!par_elements(machine(), arg1, xx, tuple)) {
+            return machine()->raise(machine()->bad_args(this, arg0, arg1));
+        }
+
+        VMObjectPtrs tt;
+        for (auto &x : xx) {
+            VMObjectPtr t[] = {arg0, x};
+            tt.push_back(VMObjectArray::create(t, 2));
+        }
+
+        VMObjectPtrs rr;
+        auto failed = par_reduce_all(machine(), tt, rr);
+        if (failed < rr.size()) return machine()->raise(rr[failed]);
+
+        return tuple ? machine()->to_tuple(rr) : machine()->to_list(rr);
+    }
+};
+
+//## System::par_all fs - concurrently evaluate 'f none' for every 'f' in a
+// list or tuple
+class ParAll : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, ParAll, "System", "par_all");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        VMObjectPtrs ff;
+        bool tuple;
+        if (!par_elements(machine(), arg0, ff, tuple)) {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+
+        auto none = machine()->create_none();
+        VMObjectPtrs tt;
+        for (auto &f : ff) {
+            VMObjectPtr t[] = {f, none};
+            tt.push_back(VMObjectArray::create(t, 2));
+        }
+
+        VMObjectPtrs rr;
+        auto failed = par_reduce_all(machine(), tt, rr);
+        if (failed < rr.size()) return machine()->raise(rr[failed]);
+
+        return tuple ? machine()->to_tuple(rr) : machine()->to_list(rr);
+    }
+};
+
+//## System::par_reduce op z xs - fold an associative 'op' over a list or
+// tuple, chunks are folded concurrently and combined from the left with 'z'
+class ParReduce : public Triadic {
+public:
+    TRIADIC_PREAMBLE(VM_SUB_BUILTIN, ParReduce, "System", "par_reduce");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0, const VMObjectPtr &arg1,
+                      const VMObjectPtr &arg2) const override {
+        VMObjectPtrs xx;
+        bool tuple;
+        if (!par_elements(machine(), arg2, xx, tuple)) {
+            return machine()->raise(
+                machine()->bad_args(this, arg0, arg1, arg2));
+        }
+
+        auto vm = machine();
+        auto n = xx.size();
+        auto chunks = par_chunks(n);
+
+        VMObjectPtrs cc(chunks, nullptr);
+        std::atomic<size_t> failed = chunks;
+        if (n > 0) {
+            ParFork::run(chunks, [vm, &arg0, &xx, &cc, &failed, n,
+                                  chunks](size_t c) {
+                auto hi = (c + 1) * n / chunks;
+                auto acc = xx[c * n / chunks];
+                for (size_t i = c * n / chunks + 1; i < hi; i++) {
+                    if (c > failed.load(std::memory_order_relaxed)) return;
+                    VMObjectPtr t[] = {arg0, acc, xx[i]};
+                    auto r = vm->reduce(VMObjectArray::create(t, 3));
+                    if (r.exception) {
+                        cc[c] = r.result;
+                        par_failed(failed, c);
+                        return;
+                    }
+                    acc = r.result;
+                }
+                cc[c] = acc;
+            });
+        }
+        if (failed < chunks) return machine()->raise(cc[failed]);
+
+        auto acc = arg1;
+        for (auto &c : cc) {
+            VMObjectPtr t[] = {arg0, acc, c};
+            auto r = vm->reduce(VMObjectArray::create(t, 3));
+            if (r.exception) return machine()->raise(r.result);
+            acc = r.result;
+        }
+        return acc;
+    }
+};
+
+//## System::future - opaque future object
+class Future : public Opaque {
+public:
+    OPAQUE_PREAMBLE(VM_SUB_BUILTIN, Future, "System", "future");
+
+    Future(VM *vm, const VMObjectPtr &f)
+        : Opaque(VM_SUB_BUILTIN, vm, "System", "future") {
+        static VMSymbol future_symbol("System", "future");
+        symbol_t sym = future_symbol(vm);
+
+        // slot 0 receives the result, slot 1 the exception
+        _result = VMObjectArray::create(2);
+        auto result = _result;
+
+        VMObjectPtr t[] = {f, vm->create_none()};
+        auto thunk = VMObjectArray::create(t, 2);
+
+        _task = VMTask::create([vm, sym, thunk, result] {
+            vm->reduce(thunk, VMObjectThreadResult::create(vm, sym, result, 0),
+                       VMObjectThreadException::create(vm, sym, result, 1));
+        });
+    }
+
+    Future(const Future &f)
+        : Opaque(VM_SUB_BUILTIN, f.machine(), f.symbol()) {
+        _result = f._result;
+        _task = f._task;
+    }
+
+    static VMObjectPtr create(VM *vm, const VMObjectPtr &f) {
+        return VMObjectPtr(new Future(vm, f));
+    }
+
+    int compare(const VMObjectPtr &o) override {
+        return -1;  // XXX: fix this once
+    }
+
+    void start() {
+        VMObject::enter_concurrent();
+        VMThreadPool::get().submit(_task);
+    }
+
+    bool ready() const {
+        return _task->done();
+    }
+
+    // help the pool until the future is resolved
+    VMReduceResult await() {
+        VMThreadPool::get().join(_task);
+
+        auto rr = VM_OBJECT_ARRAY_CAST(_result);
+        auto e = rr->get(1);
+        if (e != nullptr) {
+            return VMReduceResult{e, true};
+        } else {
+            return VMReduceResult{rr->get(0), false};
+        }
+    }
+
+protected:
+    VMObjectPtr _result;
+    VMTaskPtr _task;
+};
+
+//## System::async f - evaluate 'f none' on the worker pool, returns a future
+class Async : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, Async, "System", "async");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        auto f = Future::create(machine(), arg0);
+        vm_object_cast<Future>(f)->start();
+        return f;
+    }
+};
+
+//## System::await fut - wait for future fut and return its result, or raise
+// its exception
+class Await : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, Await, "System", "await");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        static VMSymbol future_symbol("System", "future");
+        symbol_t sym = future_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            auto r = vm_object_cast<Future>(arg0)->await();
+            if (r.exception) {
+                return machine()->raise(r.result);
+            } else {
+                return r.result;
+            }
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
+//## System::ready fut - check whether future fut is resolved, doesn't block
+class Ready : public Monadic {
+public:
+    MONADIC_PREAMBLE(VM_SUB_BUILTIN, Ready, "System", "ready");
+
+    VMObjectPtr apply(const VMObjectPtr &arg0) const override {
+        static VMSymbol future_symbol("System", "future");
+        symbol_t sym = future_symbol(machine());
+
+        if ((machine()->is_opaque(arg0)) && (arg0->symbol() == sym)) {
+            auto f = vm_object_cast<Future>(arg0);
+            return machine()->create_bool(f->ready());
+        } else {
+            return machine()->raise(machine()->bad_args(this, arg0));
+        }
+    }
+};
+
 inline std::vector<VMObjectPtr> builtin_thread(VM *vm) {
     std::vector<VMObjectPtr> oo;
 
     oo.push_back(VMObjectData::create(vm, "System", "thread"));
     oo.push_back(Par::create(vm));
+    oo.push_back(ParThreshold::create(vm));
+    oo.push_back(ParMap::create(vm));
+    oo.push_back(ParAll::create(vm));
+    oo.push_back(ParReduce::create(vm));
+    oo.push_back(VMObjectStub::create(vm, "System::future"));
+    oo.push_back(Async::create(vm));
+    oo.push_back(Await::create(vm));
+    oo.push_back(Ready::create(vm));
 
     return oo;
 }
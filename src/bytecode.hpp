@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <tuple>
 #include <vector>
@@ -31,6 +35,13 @@ enum opcode_t {
     OP_TAG,      //  x y         flag := (x, or x[0], == y)
     OP_FAIL,     //  l           pc := l, if flag
     OP_RETURN,   //  x           return x
+    OP_SWITCH,   //  x n l (i32 l)*n   pc := l of key(x), or the first l
+    OP_ADD,      //  x y z       x := y + z, flag if native
+    OP_SUB,      //  x y z       x := y - z, flag if native
+    OP_MUL,      //  x y z       x := y * z, flag if native
+    OP_LT,       //  x y z       x := y < z, flag if native
+    OP_LE,       //  x y z       x := y <= z, flag if native
+    OP_EQ,       //  x y z       x := y == z, flag if native
 };
 
 using Code = std::vector<uint8_t>;
@@ -38,6 +49,7 @@ using Data = std::vector<uint32_t>;  // XXX this is overkil after a change to a
                                      // data section
 
 using Labels = std::map<label_t, uint32_t>;
+using Cases = std::vector<std::pair<uint32_t, label_t>>;  // data, label
 
 constexpr auto OP_SIZE = 1;
 constexpr auto OP_REG_SIZE = (sizeof(reg_t));
@@ -62,8 +74,15 @@ constexpr auto STRING_OP_TEST = "test";
 constexpr auto STRING_OP_TAG = "tag";
 constexpr auto STRING_OP_FAIL = "fail";
 constexpr auto STRING_OP_RETURN = "return";
+constexpr auto STRING_OP_SWITCH = "switch";
+constexpr auto STRING_OP_ADD = "add";
+constexpr auto STRING_OP_SUB = "sub";
+constexpr auto STRING_OP_MUL = "mul";
+constexpr auto STRING_OP_LT = "lt";
+constexpr auto STRING_OP_LE = "le";
+constexpr auto STRING_OP_EQ = "eq";
 
-#define VM_OBJECT_BYTECODE_CAST(o) std::static_pointer_cast<VMObjectBytecode>(o)
+#define VM_OBJECT_BYTECODE_CAST(o) vm_object_cast<VMObjectBytecode>(o)
 
 class CodePrinter {
 public:
@@ -120,9 +139,37 @@ public:
                 OP_RETURN,
                 STRING_OP_RETURN,
             },
+            {
+                OP_SWITCH,
+                STRING_OP_SWITCH,
+            },
+            {
+                OP_ADD,
+                STRING_OP_ADD,
+            },
+            {
+                OP_SUB,
+                STRING_OP_SUB,
+            },
+            {
+                OP_MUL,
+                STRING_OP_MUL,
+            },
+            {
+                OP_LT,
+                STRING_OP_LT,
+            },
+            {
+                OP_LE,
+                STRING_OP_LE,
+            },
+            {
+                OP_EQ,
+                STRING_OP_EQ,
+            },
         };
 
-        for (int n = 0; n <= OP_RETURN; n++) {
+        for (int n = 0; n <= OP_EQ; n++) {
             if (opcode_text_table[n].op == op) {
                 return opcode_text_table[n].text;
             }
@@ -253,6 +300,12 @@ public:
                 case OP_SET:
                 case OP_SPLIT:
                 case OP_ARRAY:
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_LT:
+                case OP_LE:
+                case OP_EQ:
                     write_op(os, fetch_op());
                     write_space(os);
                     write_register(os, fetch_register());
@@ -291,6 +344,20 @@ public:
                     write_space(os);
                     write_register(os, fetch_register());
                     break;
+                case OP_SWITCH: {
+                    write_op(os, fetch_op());
+                    write_space(os);
+                    write_register(os, fetch_register());
+                    auto n = fetch_index();
+                    write_space(os);
+                    write_label(os, fetch_label());
+                    for (int i = 0; i < n; i++) {
+                        write_space(os);
+                        write_i32(os, fetch_i32());
+                        write_space(os);
+                        write_label(os, fetch_label());
+                    }
+                } break;
             }
             write_newline(os);
         }
@@ -495,6 +562,25 @@ public:
         emit_reg(x);
     }
 
+    void emit_op_switch(const reg_t x, const label_t l, const Cases &cc) {
+        emit_op(OP_SWITCH);
+        emit_reg(x);
+        emit_idx(cc.size());
+        emit_lbl(l);
+        for (auto &c : cc) {
+            emit_i32(c.first);
+            emit_lbl(c.second);
+        }
+    }
+
+    void emit_op_native(const opcode_t op, const reg_t x, const reg_t y,
+                        const reg_t z) {
+        emit_op(op);
+        emit_reg(x);
+        emit_reg(y);
+        emit_reg(z);
+    }
+
     void emit_label(const label_t l) {
         _labels[l] = _code.size();
     }
@@ -529,6 +615,12 @@ public:
                     break;
                 case OP_SPLIT:
                 case OP_ARRAY:
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_LT:
+                case OP_LE:
+                case OP_EQ:
                     pc += OP_SIZE + 3 * OP_REG_SIZE;
                     break;
                 case OP_TEST:
@@ -537,22 +629,39 @@ public:
                     break;
                 case OP_FAIL: {
                     pc += OP_SIZE;
-                    uint32_t l0 = ((_code[pc] << 24) | (_code[pc + 1] << 16) |
-                                   (_code[pc + 2] << 8) | _code[pc + 3]);
-                    uint32_t l1 = _labels[l0];
-                    _code[pc + 0] = ((l1 >> 24) & 0xFF);
-                    _code[pc + 1] = ((l1 >> 16) & 0xFF);
-                    _code[pc + 2] = ((l1 >> 8) & 0xFF);
-                    _code[pc + 3] = (l1 & 0xFF);
+                    relabel(pc);
                     pc += OP_LABEL_SIZE;
                 } break;
                 case OP_RETURN:
                     pc += OP_SIZE + 1 * OP_REG_SIZE;
                     break;
+                case OP_SWITCH: {
+                    pc += OP_SIZE + 1 * OP_REG_SIZE;
+                    uint32_t n = ((_code[pc] << 8) | _code[pc + 1]);
+                    pc += OP_INDEX_SIZE;
+                    relabel(pc);
+                    pc += OP_LABEL_SIZE;
+                    for (uint32_t i = 0; i < n; i++) {
+                        pc += OP_INT_SIZE;
+                        relabel(pc);
+                        pc += OP_LABEL_SIZE;
+                    }
+                } break;
             }
         }
     }
 
+    // replace the label at pc with its code offset
+    void relabel(uint32_t pc) {
+        uint32_t l0 = ((_code[pc] << 24) | (_code[pc + 1] << 16) |
+                       (_code[pc + 2] << 8) | _code[pc + 3]);
+        uint32_t l1 = _labels[l0];
+        _code[pc + 0] = ((l1 >> 24) & 0xFF);
+        _code[pc + 1] = ((l1 >> 16) & 0xFF);
+        _code[pc + 2] = ((l1 >> 8) & 0xFF);
+        _code[pc + 3] = (l1 & 0xFF);
+    }
+
 private:
     VM *_machine;
     Code _code;
@@ -563,71 +672,486 @@ private:
     Labels _labels;
 };
 
-#define FETCH_i8(c, pc) \
-    c[pc];              \
-    pc += 1
-#define FETCH_i16(c, pc)        \
-    ((c[pc] << 8) | c[pc + 1]); \
-    pc += 2
-#define FETCH_i32(c, pc)                                                \
-    ((c[pc] << 24) | (c[pc + 1] << 16) | (c[pc + 2] << 8) | c[pc + 3]); \
-    pc += 4
-
-#define LOOK_op(c, pc) c[pc++]
-#define FETCH_op(c, pc) FETCH_i8(c, pc)
-#define FETCH_reg(c, pc) FETCH_i16(c, pc)
-#define FETCH_idx(c, pc) FETCH_i16(c, pc)
-#define FETCH_lbl(c, pc) FETCH_i32(c, pc)
+// the key OP_SWITCH dispatches on: the symbol of a combinator, the head
+// symbol of an array, or the value of an integer or character. zero for
+// anything else. a pattern only matches objects with its own key.
+inline uint64_t switch_key(const VMObjectPtr &o) {
+    switch (o->tag()) {
+        case VM_OBJECT_INTEGER:
+            return ((uint64_t)VM_OBJECT_INTEGER_VALUE(o) << 2) | 1;
+        case VM_OBJECT_CHAR:
+            return ((uint64_t)VM_OBJECT_CHAR_VALUE(o) << 2) | 2;
+        case VM_OBJECT_COMBINATOR:
+            return ((uint64_t)o->symbol() << 2) | 3;
+        case VM_OBJECT_ARRAY: {
+            auto v = VM_OBJECT_ARRAY_VIEW(o);
+            if (v.size() > 0 && v[0]->tag() == VM_OBJECT_COMBINATOR) {
+                return ((uint64_t)v[0]->symbol() << 2) | 3;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+// the integer and float cases of the arithmetic and comparison operators
+// of System, computed in place. null for other operands and on overflow,
+// those are left to the builtin.
+inline VMObjectPtr native_operator(const int op, const VMObjectPtr &y,
+                                   const VMObjectPtr &z) {
+    bool b;
+    if (VM_OBJECT_INTEGER_TEST(y) && VM_OBJECT_INTEGER_TEST(z)) {
+        auto i0 = VM_OBJECT_INTEGER_VALUE(y);
+        auto i1 = VM_OBJECT_INTEGER_VALUE(z);
+        vm_int_t i;
+        switch (op) {
+            case OP_ADD:
+                if (__builtin_add_overflow(i0, i1, &i)) return nullptr;
+                return VMObjectInteger::create(i);
+            case OP_SUB:
+                if (__builtin_sub_overflow(i0, i1, &i)) return nullptr;
+                return VMObjectInteger::create(i);
+            case OP_MUL:
+                if (__builtin_mul_overflow(i0, i1, &i)) return nullptr;
+                return VMObjectInteger::create(i);
+            case OP_LT:
+                b = i0 < i1;
+                break;
+            case OP_LE:
+                b = i0 <= i1;
+                break;
+            default:
+                b = i0 == i1;
+                break;
+        }
+    } else if (!y.is_immediate() && !z.is_immediate() &&
+               VM_OBJECT_FLOAT_TEST(y) && VM_OBJECT_FLOAT_TEST(z)) {
+        // comparisons follow CompareVMObjectPtr
+        auto f0 = VM_OBJECT_FLOAT_VALUE(y);
+        auto f1 = VM_OBJECT_FLOAT_VALUE(z);
+        switch (op) {
+            case OP_ADD:
+                return VMObjectFloat::create(f0 + f1);
+            case OP_SUB:
+                return VMObjectFloat::create(f0 - f1);
+            case OP_MUL:
+                return VMObjectFloat::create(f0 * f1);
+            case OP_LT:
+                b = f0 < f1;
+                break;
+            case OP_LE:
+                b = !(f1 < f0);
+                break;
+            default:
+                b = !(f0 < f1) && !(f1 < f0);
+                break;
+        }
+    } else {
+        return nullptr;
+    }
+    return VMObjectPtr::immediate_constant(b ? SYMBOL_TRUE : SYMBOL_FALSE);
+}
+
+// an open addressing hash table from keys to instruction indices
+class SwitchTable {
+public:
+    SwitchTable(const std::vector<std::pair<uint64_t, uint32_t>> &cc) {
+        size_t n = 4;
+        while (n < 2 * cc.size()) n *= 2;
+        _mask = n - 1;
+        _slots.assign(n, {0, 0});
+        for (auto &c : cc) {
+            auto k = hash(c.first);
+            while (_slots[k].first != 0 && _slots[k].first != c.first) {
+                k = (k + 1) & _mask;
+            }
+            _slots[k] = c;
+        }
+    }
+
+    uint32_t find(uint64_t key, uint32_t otherwise) const {
+        for (auto k = hash(key);; k = (k + 1) & _mask) {
+            auto &s = _slots[k];
+            if (s.first == key && key != 0) return s.second;
+            if (s.first == 0) return otherwise;
+        }
+    }
+
+private:
+    size_t hash(uint64_t key) const {
+        return (key * 0x9e3779b97f4a7c15ull >> 32) & _mask;
+    }
+
+    size_t _mask;
+    std::vector<std::pair<uint64_t, uint32_t>> _slots;
+};
+
+/*----------------------------------------------------------------------
+superinstructions, fused from sequences the emitter produces a lot. they
+only occur in threaded code.
+----------------------------------------------------------------------*/
+enum superop_t {
+    OP_MOV2 = OP_EQ + 1,      //  x y z w       x := y; z := w
+    OP_DATA_TEST_FAIL,        //  x i32 y l     x := data(i32); test y x; fail l
+    OP_DATA_TAG_FAIL,         //  x i32 y l     x := data(i32); tag y x; fail l
+    OP_TAKEX_FAIL,            //  x y z i16 l   takex x y z i16; fail l
+    OP_SPLIT_FAIL,            //  x y z l       split x y z; fail l
+    OP_THREADED_COUNT,
+};
+
+// a decoded instruction. operands are widened and aligned, labels are
+// resolved to instruction indices, and with threaded dispatch it holds the
+// address of its handler
+struct instruction_t {
+    const void *handler;
+    uint32_t i;  // i16 or i32 operand, or a fourth register
+    uint32_t l;  // label
+    reg_t x;
+    reg_t y;
+    reg_t z;
+    uint16_t op;
+};
+
+using Threaded = std::vector<instruction_t>;
+
+class CodeThreader {
+public:
+    CodeThreader(VM *vm, const Code &code, const Data &data)
+        : _machine(vm), _code(code), _data(data), _pc(0), _registers(1) {
+    }
+
+    Threaded thread(const void *const *handlers) {
+        decode();
+        fuse();
+        resolve(handlers);
+        return _threaded;
+    }
+
+    // the exact size of the register frame
+    size_t registers() const {
+        return _registers;
+    }
+
+    // the tables of the OP_SWITCH instructions
+    std::vector<SwitchTable> switches() const {
+        return _switches;
+    }
+
+private:
+    uint16_t fetch_i16() {
+        uint16_t n = ((_code[_pc] << 8) | _code[_pc + 1]);
+        _pc += 2;
+        return n;
+    }
+
+    uint32_t fetch_i32() {
+        uint32_t n = ((_code[_pc] << 24) | (_code[_pc + 1] << 16) |
+                      (_code[_pc + 2] << 8) | _code[_pc + 3]);
+        _pc += 4;
+        return n;
+    }
+
+    void decode() {
+        _index.assign(_code.size() + 1, 0);
+        _target.assign(_code.size() + 1, false);
+        while (_pc < _code.size()) {
+            _index[_pc] = _decoded.size();
+            _offset.push_back(_pc);
+            instruction_t c = {};
+            c.op = _code[_pc++];
+            switch (c.op) {
+                case OP_NIL:
+                case OP_RETURN:
+                    c.x = fetch_i16();
+                    break;
+                case OP_MOV:
+                case OP_TEST:
+                case OP_TAG:
+                    c.x = fetch_i16();
+                    c.y = fetch_i16();
+                    break;
+                case OP_DATA:
+                    c.x = fetch_i16();
+                    c.i = fetch_i32();
+                    break;
+                case OP_SET:
+                case OP_SPLIT:
+                case OP_ARRAY:
+                case OP_ADD:
+                case OP_SUB:
+                case OP_MUL:
+                case OP_LT:
+                case OP_LE:
+                case OP_EQ:
+                    c.x = fetch_i16();
+                    c.y = fetch_i16();
+                    c.z = fetch_i16();
+                    break;
+                case OP_TAKEX:
+                case OP_CONCATX:
+                    c.x = fetch_i16();
+                    c.y = fetch_i16();
+                    c.z = fetch_i16();
+                    c.i = fetch_i16();
+                    break;
+                case OP_FAIL:
+                    c.l = fetch_i32();
+                    _target[c.l] = true;
+                    break;
+                case OP_SWITCH: {
+                    c.x = fetch_i16();
+                    auto n = fetch_i16();
+                    c.l = fetch_i32();
+                    _target[c.l] = true;
+                    c.i = _cases.size();
+                    std::vector<std::pair<uint64_t, uint32_t>> cc;
+                    for (int k = 0; k < n; k++) {
+                        auto o = _machine->get_data(_data[fetch_i32()]);
+                        auto l = fetch_i32();
+                        _target[l] = true;
+                        cc.emplace_back(switch_key(o), l);
+                    }
+                    _cases.push_back(cc);
+                } break;
+                default:
+                    PANIC("couldn't decode opcode");
+            }
+            _registers = std::max<size_t>(
+                {_registers, c.x + 1u, c.y + 1u, c.z + 1u});
+            _decoded.push_back(c);
+        }
+        _index[_code.size()] = _decoded.size();
+        _start.assign(_decoded.size() + 1, 0);
+    }
+
+    // the instructions at k+1..k+n exist and aren't jumped to
+    bool fusable(size_t k, size_t n) const {
+        if (k + n >= _decoded.size()) return false;
+        for (size_t m = k + 1; m <= k + n; m++) {
+            if (_target[_offset[m]]) return false;
+        }
+        return true;
+    }
+
+    void fuse() {
+        auto &dd = _decoded;
+        size_t k = 0;
+        while (k < dd.size()) {
+            _start[k] = _threaded.size();
+            auto c = dd[k];
+            if (c.op == OP_MOV && fusable(k, 1) && dd[k + 1].op == OP_MOV) {
+                c.op = OP_MOV2;
+                c.z = dd[k + 1].x;
+                c.i = dd[k + 1].y;
+                k += 2;
+            } else if (c.op == OP_DATA && fusable(k, 2) &&
+                       (dd[k + 1].op == OP_TEST || dd[k + 1].op == OP_TAG) &&
+                       dd[k + 1].y == c.x && dd[k + 2].op == OP_FAIL) {
+                c.op = (dd[k + 1].op == OP_TEST) ? OP_DATA_TEST_FAIL
+                                                 : OP_DATA_TAG_FAIL;
+                c.y = dd[k + 1].x;
+                c.l = dd[k + 2].l;
+                k += 3;
+            } else if ((c.op == OP_TAKEX || c.op == OP_SPLIT) &&
+                       fusable(k, 1) && dd[k + 1].op == OP_FAIL) {
+                c.op = (c.op == OP_TAKEX) ? OP_TAKEX_FAIL : OP_SPLIT_FAIL;
+                c.l = dd[k + 1].l;
+                k += 2;
+            } else {
+                k += 1;
+            }
+            _threaded.push_back(c);
+        }
+        _start[dd.size()] = _threaded.size();
+    }
+
+    void resolve(const void *const *handlers) {
+        for (auto &c : _threaded) {
+            switch (c.op) {
+                case OP_FAIL:
+                case OP_DATA_TEST_FAIL:
+                case OP_DATA_TAG_FAIL:
+                case OP_TAKEX_FAIL:
+                case OP_SPLIT_FAIL:
+                    c.l = _start[_index[c.l]];
+                    break;
+                case OP_SWITCH:
+                    c.l = _start[_index[c.l]];
+                    break;
+                default:
+                    break;
+            }
+            c.handler = (handlers == nullptr) ? nullptr : handlers[c.op];
+        }
+        for (auto &cc : _cases) {
+            for (auto &c : cc) {
+                c.second = _start[_index[c.second]];
+            }
+            _switches.emplace_back(cc);
+        }
+    }
+
+    VM *_machine;
+    const Code &_code;
+    const Data &_data;
+    uint32_t _pc;
+    size_t _registers;
+    std::vector<std::vector<std::pair<uint64_t, uint32_t>>> _cases;
+    std::vector<SwitchTable> _switches;
+    Threaded _decoded;
+    Threaded _threaded;
+    std::vector<uint32_t> _index;  // from code offset to decoded instruction
+    std::vector<uint32_t> _offset;  // and back
+    std::vector<bool> _target;     // code offsets which are jumped to
+    std::vector<uint32_t> _start;  // from decoded to threaded instruction
+};
 
+// with GCC and Clang every instruction jumps directly to the handler of the
+// next through a computed goto, otherwise the interpreter loops over a switch
+#if defined(__GNUC__) && !defined(EGEL_SWITCH_DISPATCH)
+#define EGEL_THREADED_DISPATCH
+#endif
+
+#ifdef EGEL_THREADED_DISPATCH
+#define BYTECODE_BEGIN BYTECODE_NEXT();
+#define BYTECODE_END
+#define BYTECODE_HANDLER(op) L_##op:
+#define BYTECODE_NEXT() goto *ip->handler
+#else
+#define BYTECODE_BEGIN \
+    while (true) {     \
+        switch (ip->op) {
+#define BYTECODE_END \
+    }                \
+    }
+#define BYTECODE_HANDLER(op) case op:
+#define BYTECODE_NEXT() continue
+#endif
+
+#define BYTECODE_COUNT(n) \
+    if (counting) ops += n
+
+// register frames are exactly sized and taken from the top of a per-thread
+// stack of segments, a reduction clears its frame when it returns it
 class Registers {
 public:
-    Registers() {
-        //_fast.reserve(MAX_REGISTERS);
+    explicit Registers(size_t n) : _size(n) {
+        auto &s = _stack;
+        _segment = s.segment;
+        _top = s.top;
+        if (s.segment == nullptr || s.top + n > s.segment->size) {
+            s.segment = next(s.segment, n);
+            s.top = 0;
+        }
+        _frame = s.segment->slots + s.top;
+        s.top += n;
     }
 
-    const VMObjectPtr get(const reg_t n) {
-        if (n < MAX_REGISTERS) {
-            return _fast[n];
-        } else {
-            return _fallback[n];
+    Registers(const Registers &) = delete;
+    Registers &operator=(const Registers &) = delete;
+
+    ~Registers() {
+        for (size_t n = 0; n < _size; n++) {
+            _frame[n] = nullptr;
         }
+        _stack.segment = _segment;
+        _stack.top = _top;
+    }
+
+    const VMObjectPtr &get(const reg_t n) const {
+        return _frame[n];
     }
 
     void set(const reg_t n, const VMObjectPtr &o) {
-        if (n < MAX_REGISTERS) {
-            _fast[n] = o;
-        } else {
-            _fallback[n] = o;
-        }
+        _frame[n] = o;
+    }
+
+    void set(const reg_t n, VMObjectPtr &&o) {
+        _frame[n] = std::move(o);
     }
 
-    const VMObjectPtr operator[](const reg_t n) {
+    const VMObjectPtr &operator[](const reg_t n) const {
         return get(n);
     }
 
 private:
-    static const int MAX_REGISTERS = 64;
+    static constexpr size_t SEGMENT_SIZE = 1024;
+
+    struct segment_t {
+        segment_t *next;
+        size_t size;
+        VMObjectPtr *slots;
+    };
+
+    // the stack itself is trivially destructible to keep thread local
+    // access cheap, the reaper frees its segments when a thread exits
+    struct stack_t {
+        segment_t *base;
+        segment_t *segment;
+        size_t top;
+    };
+
+    struct reaper_t {
+        void touch() {
+        }
+
+        ~reaper_t() {
+            auto g = _stack.base;
+            while (g != nullptr) {
+                auto h = g->next;
+                delete[] g->slots;
+                delete g;
+                g = h;
+            }
+            _stack = {};
+        }
+    };
+
+    // the segment after g, a fresh one if that can't hold n registers
+    static segment_t *next(segment_t *g, size_t n) {
+        auto link = (g == nullptr) ? &_stack.base : &g->next;
+        if (*link == nullptr || (*link)->size < n) {
+            auto sz = std::max(n, SEGMENT_SIZE);
+            *link = new segment_t{*link, sz, new VMObjectPtr[sz]};
+            _reaper.touch();
+        }
+        return *link;
+    }
 
-    VMObjectPtr _fast[MAX_REGISTERS];
-    std::map<reg_t, VMObjectPtr> _fallback;
+    size_t _size;
+    VMObjectPtr *_frame;
+    segment_t *_segment;
+    size_t _top;
+
+    static inline constinit thread_local stack_t _stack = {};
+    static inline thread_local reaper_t _reaper;
 };
 
 class VMObjectBytecode : public VMObjectCombinator {
 public:
     VMObjectBytecode(VM *m, const Code &c, const Data &d, const symbol_t s)
-        : VMObjectCombinator(VM_SUB_BYTECODE, m, s), _code(c), _data(d){};
+        : VMObjectCombinator(VM_SUB_BYTECODE, m, s), _code(c), _data(d) {
+        thread();
+    }
 
     VMObjectBytecode(VM *m, const Code &c, const Data &d,
                      const icu::UnicodeString &n)
-        : VMObjectCombinator(VM_SUB_BYTECODE, m, n), _code(c), _data(d){};
+        : VMObjectCombinator(VM_SUB_BYTECODE, m, n), _code(c), _data(d) {
+        thread();
+    }
 
     VMObjectBytecode(VM *m, const Code &c, const Data &d,
                      const icu::UnicodeString &n0, const icu::UnicodeString &n1)
-        : VMObjectCombinator(VM_SUB_BYTECODE, m, n0, n1), _code(c), _data(d){};
+        : VMObjectCombinator(VM_SUB_BYTECODE, m, n0, n1), _code(c), _data(d) {
+        thread();
+    }
 
     VMObjectBytecode(VM *m, const Code &c, const Data &d,
                      const UnicodeStrings &nn, const icu::UnicodeString &n)
-        : VMObjectCombinator(VM_SUB_BYTECODE, m, nn, n), _code(c), _data(d){};
+        : VMObjectCombinator(VM_SUB_BYTECODE, m, nn, n), _code(c), _data(d) {
+        thread();
+    }
 
     VMObjectBytecode(const VMObjectBytecode &d)
         : VMObjectBytecode(d.machine(), d.code(), d.data(), d.symbol()) {
@@ -636,16 +1160,16 @@ public:
     static VMObjectPtr create(VM *m, const Code &c, const Data &d,
                               const UnicodeStrings &nn,
                               const icu::UnicodeString &n) {
-        return std::make_shared<VMObjectBytecode>(m, c, d, nn, n);
+        return VMObjectPtr(new VMObjectBytecode(m, c, d, nn, n));
     }
 
     static VMObjectPtr create(VM *m, const Code &c, const Data &d,
                               const icu::UnicodeString &s) {
-        return std::make_shared<VMObjectBytecode>(m, c, d, s);
+        return VMObjectPtr(new VMObjectBytecode(m, c, d, s));
     }
 
-    static std::shared_ptr<VMObjectBytecode> cast(const VMObjectPtr &o) {
-        return std::static_pointer_cast<VMObjectBytecode>(o);
+    static VMObjectRef<VMObjectBytecode> cast(const VMObjectPtr &o) {
+        return vm_object_cast<VMObjectBytecode>(o);
     }
 
     void debug(std::ostream &os) const override {
@@ -681,206 +1205,399 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        // debug(std::cout);
-        Registers reg;
-        uint32_t pc = 0;
-        reg.set(0, thunk);
-        bool flag = false;
+        return interpret(thunk, nullptr);
+    }
 
-        EqualVMObjectPtr equals;
+private:
+    void thread() {
+        const void *const *handlers;
+        interpret(nullptr, &handlers);
+        CodeThreader t(machine(), _code, _data);
+        _threaded = t.thread(handlers);
+        _registers = t.registers();
+        _switches = t.switches();
+    }
+
+    // constants are resolved once into a pool, it is linked again only
+    // after a redefinition; the pool does not count its constants, the
+    // data table owns them, and the machine frees retired pools and
+    // entries once no reducer can still be reading them
+    const uintptr_t *constants() const {
+        if (_linked.load(std::memory_order_acquire) !=
+            machine()->data_epoch()) {
+            link();
+        }
+        return _pool.load();
+    }
 
-        while (true) {
-            switch (LOOK_op(_code, pc)) {
-                case OP_NIL: {
-                    //  x           x := null
-                    reg_t x = FETCH_reg(_code, pc);
+    void link() const {
+        std::lock_guard<std::mutex> lock(_link);
+        auto e = machine()->data_epoch();
+        if (_linked.load(std::memory_order_relaxed) == e) return;
 
-                    reg.set(x, nullptr);
-                } break;
-                case OP_MOV: {
-                    //  x y         x := y
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
+        auto n = _data.size();
+        auto next = std::make_unique<uintptr_t[]>(n);
+        bool same = (_current != nullptr);
+        for (size_t i = 0; i < n; i++) {
+            next[i] = machine()->get_data(_data[i]).uncounted();
+            same = same && (next[i] == _current[i]);
+        }
+        if (!same) {
+            _pool.store(next.get());
+            std::swap(_current, next);
+            if (next != nullptr) machine()->retire(std::move(next));
+        }
+        _linked.store(e, std::memory_order_release);
+    }
+
+    // with threaded dispatch the handlers are labels local to the
+    // interpreter, it hands them out when asked instead of reducing
+#ifdef EGEL_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"  // labels as values
+#endif
+    VMObjectPtr interpret(const VMObjectPtr &thunk,
+                          const void *const **handlers) const {
+#ifdef EGEL_THREADED_DISPATCH
+        static const void *const table[OP_THREADED_COUNT] = {
+            &&L_OP_NIL,
+            &&L_OP_MOV,
+            &&L_OP_DATA,
+            &&L_OP_SET,
+            &&L_OP_TAKEX,
+            &&L_OP_SPLIT,
+            &&L_OP_ARRAY,
+            &&L_OP_CONCATX,
+            &&L_OP_TEST,
+            &&L_OP_TAG,
+            &&L_OP_FAIL,
+            &&L_OP_RETURN,
+            &&L_OP_SWITCH,
+            &&L_OP_ADD,
+            &&L_OP_SUB,
+            &&L_OP_MUL,
+            &&L_OP_LT,
+            &&L_OP_LE,
+            &&L_OP_EQ,
+            &&L_OP_MOV2,
+            &&L_OP_DATA_TEST_FAIL,
+            &&L_OP_DATA_TAG_FAIL,
+            &&L_OP_TAKEX_FAIL,
+            &&L_OP_SPLIT_FAIL,
+        };
+        if (handlers != nullptr) {
+            *handlers = table;
+            return nullptr;
+        }
+#else
+        if (handlers != nullptr) {
+            *handlers = nullptr;
+            return nullptr;
+        }
+#endif
 
-                    reg.set(x, reg[y]);
-                } break;
-                case OP_DATA: {
-                    //  x i32       x := data(i32)
-                    reg_t x = FETCH_reg(_code, pc);
-                    int32_t i32 = FETCH_i32(_code, pc);
+        // debug(std::cout);
+        const uintptr_t *pool = constants();
+        Registers reg(_registers);
+        const instruction_t *code = _threaded.data();
+        const instruction_t *ip = code;
+        reg.set(0, thunk);
+        bool flag = false;
+        // opcodes, not instructions, counted only for the statistics
+        const bool counting = VMStats::enabled();
+        uint64_t ops = 0;
 
-                    reg.set(x, machine()->get_data(_data[i32]));
-                } break;
-                case OP_SET: {
-                    //  x y z       x[val(y)] := z
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-                    reg_t z = FETCH_reg(_code, pc);
+        EqualVMObjectPtr equals;
 
-                    auto x0 = reg[x];
-                    auto y0 = reg[y];
-                    auto z0 = reg[z];
+        BYTECODE_BEGIN
+        BYTECODE_HANDLER(OP_NIL) {
+            //  x           x := null
+            reg.set(ip->x, nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_MOV) {
+            //  x y         x := y
+            reg.set(ip->x, reg[ip->y]);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_DATA) {
+            //  x i32       x := data(i32)
+            reg.set(ip->x, VMObjectPtr::from_uncounted(pool[ip->i]));
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_SET) {
+            //  x y z       x[val(y)] := z
+            const auto &x0 = reg[ip->x];
+            const auto &y0 = reg[ip->y];
+            const auto &z0 = reg[ip->z];
+
+            ASSERT(machine()->is_array(x0));
+            ASSERT(y0->tag() == VM_OBJECT_INTEGER);
+
+            auto xv = VM_OBJECT_ARRAY_CAST(x0);
+            auto yv = machine()->get_integer(y0);
+
+            xv->set(yv, z0);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_TAKEX) {
+            //  x y z i     x,..,y = z[i],..,z[i+y-x], flag fail
+            flag = takex(reg, ip);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_SPLIT) {
+            //  x y z       x,..,y = z[0],..,z[y-x], flag not exact
+            flag = split(reg, ip);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_ARRAY) {
+            //  x y z       x := [ y, y+1,.., z ]
+            reg_t x = ip->x;
+            reg_t y = ip->y;
+            reg_t z = ip->z;
+
+            size_t sz = (size_t)z - y + 1;
+            if (sz > 0) {  // we do generate empty arrays sometimes
+                auto oo = VM_OBJECT_ARRAY_CAST(VMObjectArray::create(sz));
+                for (reg_t n = y; n <= z; n++) {
+                    oo->set(n - y, reg[n]);
+                }
+                reg.set(x, oo);
+            } else {
+                auto oo = VM_OBJECT_ARRAY_CAST(VMObjectArray::create(0));
+                reg.set(x, oo);
+            }
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_CONCATX) {
+            //  x y z i     x := y ++ drop i z
+            reg_t x = ip->x;
+            size_t i = ip->i;
 
-                    ASSERT(machine()->is_array(x0));
-                    ASSERT(y0->tag() == VM_OBJECT_INTEGER);
+            const auto &y0 = reg[ip->y];
+            const auto &z0 = reg[ip->z];
+            if ((machine()->is_array(y0)) && (machine()->is_array(z0))) {
+                auto yc = VM_OBJECT_ARRAY_CAST(y0);
+                auto zc = VM_OBJECT_ARRAY_CAST(z0);
 
-                    auto xv = VM_OBJECT_ARRAY_CAST(x0);
-                    auto yv = machine()->get_integer(y0);
+                size_t sz = yc->size() + zc->size() - i;
 
-                    xv->set(yv, z0);
-                } break;
-                case OP_TAKEX: {
-                    //  x y z i     x,..,y = z[i],..,z[i+y-x], flag fail
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-                    reg_t z = FETCH_reg(_code, pc);
-                    index_t i = FETCH_idx(_code, pc);
-
-                    auto z0 = reg[z];
-                    if (machine()->is_array(z0)) {
-                        auto zz = VM_OBJECT_ARRAY_CAST(z0);
-                        flag =
-                            (((int)y - (int)x + 1) <= (int)zz->size() - (int)i);
-                        if (flag) {
-                            for (reg_t n = x; n <= y; n++) {
-                                reg.set(n, zz->get(n - x + i));
-                            }
-                        } else {
-                            // XXX: insert prefetch code here once
-                        }
-                    } else {
-                        flag = false;
-                    }
-                } break;
-                case OP_SPLIT: {
-                    //  x y z       x,..,y = z[0],..,z[y-x], flag not exact
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-                    reg_t z = FETCH_reg(_code, pc);
-
-                    auto z0 = reg[z];
-                    if (machine()->is_array(z0)) {
-                        auto zz = VM_OBJECT_ARRAY_CAST(z0);
-                        flag = (((int)y - (int)x + 1) == (int)zz->size());
-                        if (flag) {
-                            for (reg_t n = x; n <= y; n++) {
-                                reg.set(n, zz->get(n - x));
-                            }
-                        } else {
-                            // XXX: insert prefetch code here once
-                        }
-                    } else {
-                        flag = false;
-                    }
-                } break;
-                case OP_ARRAY: {
-                    //  x y z       x := [ y, y+1,.., z ]
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-                    reg_t z = FETCH_reg(_code, pc);
-
-                    size_t sz = (size_t)z - y + 1;
-                    if (sz > 0) {  // we do generate empty arrays sometimes
+                if (i < zc->size()) {  // there are members in z to be copied
+                    if (sz > 1) {
                         auto oo =
                             VM_OBJECT_ARRAY_CAST(VMObjectArray::create(sz));
-                        for (reg_t n = y; n <= z; n++) {
-                            oo->set(n - y, reg[n]);
+                        size_t l = 0;
+                        for (size_t n = 0; n < yc->size(); n++) {
+                            oo->set(l, yc->get(n));
+                            l++;
+                        }
+                        for (size_t n = i; n < zc->size(); n++) {
+                            oo->set(l, zc->get(n));
+                            l++;
                         }
                         reg.set(x, oo);
                     } else {
-                        auto oo =
-                            VM_OBJECT_ARRAY_CAST(VMObjectArray::create(0));
-                        reg.set(x, oo);
+                        auto o = zc->get(i);
+                        reg.set(x, o);
                     }
-                } break;
-                case OP_CONCATX: {
-                    //  x y z i     x := y ++ drop i z
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-                    reg_t z = FETCH_reg(_code, pc);
-                    index_t i = FETCH_idx(_code, pc);
-
-                    auto y0 = reg[y];
-                    auto z0 = reg[z];
-                    if ((machine()->is_array(y0)) &&
-                        (machine()->is_array(z0))) {
-                        auto yc = VM_OBJECT_ARRAY_CAST(y0);
-                        auto zc = VM_OBJECT_ARRAY_CAST(z0);
-
-                        size_t sz = yc->size() + zc->size() - i;
-
-                        if (i < zc->size()) {  // there are members in z to be
-                                               // copied
-
-                            if (sz > 1) {
-                                auto oo = VM_OBJECT_ARRAY_CAST(
-                                    VMObjectArray::create(sz));
-                                size_t l = 0;
-                                for (size_t n = 0; n < yc->size(); n++) {
-                                    oo->set(l, yc->get(n));
-                                    l++;
-                                }
-                                for (size_t n = i; n < zc->size(); n++) {
-                                    oo->set(l, zc->get(n));
-                                    l++;
-                                }
-                                reg.set(x, oo);
-                            } else {
-                                auto o = zc->get(i);
-                                reg.set(x, o);
-                            }
-                        } else {  // optimize for `drop i z = {}` case
-                            if (yc->size() == 1) {  // XXX: move to reg.set?
-                                reg.set(x, yc->get(0));
-                            } else {
-                                reg.set(x, y0);
-                            }
-                        }
+                } else {  // optimize for `drop i z = {}` case
+                    if (yc->size() == 1) {  // XXX: move to reg.set?
+                        reg.set(x, yc->get(0));
                     } else {
-                        PANIC("two arrays expected");
-                        return nullptr;
+                        reg.set(x, y0);
                     }
-                } break;
-                case OP_TEST: {
-                    //  x y         flag := (x == y)
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-
-                    auto x0 = reg[x];
-                    auto y0 = reg[y];
-                    flag = equals(x0, y0);
-                } break;
-                case OP_TAG: {
-                    //  x y         flag := (x, or x[0], == y)
-                    reg_t x = FETCH_reg(_code, pc);
-                    reg_t y = FETCH_reg(_code, pc);
-
-                    auto x0 = reg[x];
-                    auto y0 = reg[y];
-
-                    auto s0 = x0->symbol();
-                    auto s1 = y0->symbol();
+                }
+            } else {
+                PANIC("two arrays expected");
+                return nullptr;
+            }
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_TEST) {
+            //  x y         flag := (x == y)
+            flag = equals(reg[ip->x], reg[ip->y]);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_TAG) {
+            //  x y         flag := (x, or x[0], == y)
+            flag = (reg[ip->x]->symbol() == reg[ip->y]->symbol());
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_FAIL) {
+            //  l           pc := l, if ~flag
+            BYTECODE_COUNT(1);
+            ip = flag ? ip + 1 : code + ip->l;
+            flag = false;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_RETURN) {
+            //  x           return x
+            if (counting) VMStats::count_opcodes(ops + 1);
+            return reg[ip->x];
+        }
+        BYTECODE_HANDLER(OP_SWITCH) {
+            //  x n l ..    pc := l of key(x), or the first l
+            BYTECODE_COUNT(1);
+            auto &t = _switches[ip->i];
+            ip = code + t.find(switch_key(reg[ip->x]), ip->l);
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_ADD) {
+            //  x y z       x := y + z, flag if native
+            reg.set(ip->x, native_operator(OP_ADD, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_SUB) {
+            //  x y z       x := y - z, flag if native
+            reg.set(ip->x, native_operator(OP_SUB, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_MUL) {
+            //  x y z       x := y * z, flag if native
+            reg.set(ip->x, native_operator(OP_MUL, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_LT) {
+            //  x y z       x := y < z, flag if native
+            reg.set(ip->x, native_operator(OP_LT, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_LE) {
+            //  x y z       x := y <= z, flag if native
+            reg.set(ip->x, native_operator(OP_LE, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_EQ) {
+            //  x y z       x := y == z, flag if native
+            reg.set(ip->x, native_operator(OP_EQ, reg[ip->y], reg[ip->z]));
+            flag = (reg[ip->x] != nullptr);
+            BYTECODE_COUNT(1);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_MOV2) {
+            //  x y z w     x := y; z := w
+            reg.set(ip->x, reg[ip->y]);
+            reg.set(ip->z, reg[ip->i]);
+            BYTECODE_COUNT(2);
+            ip++;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_DATA_TEST_FAIL) {
+            //  x i32 y l   x := data(i32); test y x; fail l
+            reg.set(ip->x, VMObjectPtr::from_uncounted(pool[ip->i]));
+            BYTECODE_COUNT(3);
+            ip = equals(reg[ip->y], reg[ip->x]) ? ip + 1 : code + ip->l;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_DATA_TAG_FAIL) {
+            //  x i32 y l   x := data(i32); tag y x; fail l
+            reg.set(ip->x, VMObjectPtr::from_uncounted(pool[ip->i]));
+            BYTECODE_COUNT(3);
+            ip = (reg[ip->y]->symbol() == reg[ip->x]->symbol())
+                     ? ip + 1
+                     : code + ip->l;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_TAKEX_FAIL) {
+            //  x y z i l   takex x y z i; fail l
+            BYTECODE_COUNT(2);
+            ip = takex(reg, ip) ? ip + 1 : code + ip->l;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_HANDLER(OP_SPLIT_FAIL) {
+            //  x y z l     split x y z; fail l
+            BYTECODE_COUNT(2);
+            ip = split(reg, ip) ? ip + 1 : code + ip->l;
+            BYTECODE_NEXT();
+        }
+        BYTECODE_END
 
-                    flag = (s0 == s1);
-                } break;
-                case OP_FAIL: {
-                    //  l           pc := l, if ~flag
-                    label_t l = FETCH_lbl(_code, pc);
+        PANIC("invalid opcode");
+        return nullptr;
+    }
+#ifdef EGEL_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+    bool takex(Registers &reg, const instruction_t *ip) const {
+        reg_t x = ip->x;
+        reg_t y = ip->y;
+        size_t i = ip->i;
+
+        const auto &z0 = reg[ip->z];
+        if (machine()->is_array(z0)) {
+            auto zz = VM_OBJECT_ARRAY_CAST(z0);
+            if (((int)y - (int)x + 1) <= (int)zz->size() - (int)i) {
+                for (reg_t n = x; n <= y; n++) {
+                    reg.set(n, zz->get(n - x + i));
+                }
+                return true;
+            }
+        }
+        return false;
+    }
 
-                    if (!flag) pc = l;
-                    flag = false;
-                } break;
-                case OP_RETURN: {
-                    //  x           return x
-                    reg_t x = FETCH_reg(_code, pc);
+    bool split(Registers &reg, const instruction_t *ip) const {
+        reg_t x = ip->x;
+        reg_t y = ip->y;
 
-                    return reg[x];
-                } break;
+        const auto &z0 = reg[ip->z];
+        if (machine()->is_array(z0)) {
+            auto zz = VM_OBJECT_ARRAY_CAST(z0);
+            if (((int)y - (int)x + 1) == (int)zz->size()) {
+                for (reg_t n = x; n <= y; n++) {
+                    reg.set(n, zz->get(n - x));
+                }
+                return true;
             }
         }
+        return false;
     }
 
-private:
     Code _code;
     Data _data;
+    Threaded _threaded;
+    size_t _registers;
+    std::vector<SwitchTable> _switches;
+    mutable std::mutex _link;
+    mutable std::atomic<uint64_t> _linked = 0;
+    mutable std::atomic<const uintptr_t *> _pool = nullptr;
+    mutable std::unique_ptr<uintptr_t[]> _current;
 };
+
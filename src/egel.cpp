@@ -1,3 +1,7 @@
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+
 #include "machine.hpp"
 #include "runtime.hpp"
 
@@ -16,6 +20,13 @@
 
 #define EGEL_PATH "/usr/local/lib/egel"
 
+// the runtime state shared with the modules
+#ifdef EGEL_ATOMIC_REFCOUNT
+constinit VMRuntime egel_runtime = {true, false, false, {}, nullptr, 0, 0};
+#else
+constinit VMRuntime egel_runtime = {false, false, false, {}, nullptr, 0, 0};
+#endif
+
 enum arg_t {
     OPTION_NONE,
     OPTION_FILE,
@@ -98,6 +109,30 @@ static option_t options[] = {
         OPTION_NONE,
         "output bytecode (debug)",
     },
+    {
+        "-S",
+        "--stats",
+        OPTION_NONE,
+        "print reduction statistics as json on exit",
+    },
+    {
+        "-P",
+        "--profile",
+        OPTION_FILE,
+        "sample reductions, write collapsed stacks to file",
+    },
+    {
+        "-A",
+        "--alloc",
+        OPTION_TEXT,
+        "object allocator, 'pool' or 'system' (default)",
+    },
+    {
+        "-W",
+        "--workers",
+        OPTION_NUMBER,
+        "number of worker threads for par (default: all cores)",
+    },
 };
 
 using StringPairs =
@@ -192,6 +227,37 @@ void display_version() {
     std::cout << EXECUTABLE_COPYRIGHT << ' ' << EXECUTABLE_AUTHORS << std::endl;
 }
 
+// statistics and the profile are written once the program is done, or
+// from an exit handler when the program ends with OS::exit
+struct report_t {
+    VM *machine = nullptr;
+    bool stats = false;
+    std::string profile;
+};
+
+static report_t report_state;
+
+bool report() {
+    auto &r = report_state;
+    auto m = std::exchange(r.machine, nullptr);
+    if (m == nullptr) return true;
+
+    if (r.stats) {
+        VMStats::render(std::cerr, m);
+        std::cerr << std::endl;
+    }
+
+    if (r.profile != "") {
+        std::ofstream f(r.profile);
+        if (!f) {
+            std::cerr << "cannot write profile: " << r.profile << std::endl;
+            return false;
+        }
+        VMStats::render_profile(f, m);
+    }
+    return true;
+}
+
 int main(int argc, char *argv[]) {
     // parse the options (quick and dirty)
     StringPairs pp;
@@ -285,8 +351,55 @@ int main(int argc, char *argv[]) {
         };
     };
 
+    // select the object allocator before any object is created
+    for (auto &p : pp) {
+        if (p.first == ("-A")) {
+            if (p.second == "pool") {
+                VMAllocator::use_pool(true);
+            } else if (p.second == "system") {
+                VMAllocator::use_pool(false);
+            } else {
+                std::cerr << "unknown allocator, try -h." << std::endl;
+                return (EXIT_FAILURE);
+            }
+        };
+    };
+
+    // size the work-stealing pool before par first starts it
+    for (auto &p : pp) {
+        if (p.first == ("-W")) {
+            std::string n;
+            p.second.toUTF8String(n);
+            char *end;
+            auto w = strtol(n.c_str(), &end, 10);
+            if (*end != '\0' || w < 1) {
+                std::cerr << "bad number of workers, try -h." << std::endl;
+                return (EXIT_FAILURE);
+            }
+            VMThreadPool::workers(w);
+        };
+    };
+
+    // count reductions only when statistics or a profile are asked for,
+    // sample every so many reduction steps when profiling
+    for (auto &p : pp) {
+        if (p.first == ("-S")) {
+            report_state.stats = true;
+            VMStats::enable();
+        };
+        if (p.first == ("-P")) {
+            p.second.toUTF8String(report_state.profile);
+            VMStats::enable();
+            VMStats::profile(997);
+        };
+    };
+
     // create a machine
     VMPtr m = Machine::create();
+    if (VMStats::enabled()) {
+        report_state.machine = m.get();
+        std::atexit([] { report(); });
+    }
 
     // initialize (rebinding exceptions need to be caught)
     try {
@@ -325,5 +438,12 @@ int main(int argc, char *argv[]) {
         m->eval_main();
     }
 
+    // stop the workers, tasks still waiting are abandoned; the machine is
+    // left to a task still computing
+    if (!VMThreadPool::shutdown()) new VMPtr(m);
+
+    // report statistics and write the profile
+    if (!report()) return (EXIT_FAILURE);
+
     return EXIT_SUCCESS;
 }
@@ -3,7 +3,11 @@
 inline void emit_data(VM *vm, const AstPtr &a);
 inline void emit_code(VM *vm, const AstPtr &a);
 
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "ast.hpp"
@@ -374,99 +378,185 @@ public:
 
             case EMIT_EXPR_ROOT:
             case EMIT_EXPR: {  // XXX
-
-                // generate labels rt, rti, k, exc, c, x .. y
-                auto rt = get_coder()->generate_register();
-                auto rti = get_coder()->generate_register();
-                auto k = get_coder()->generate_register();
-                auto exc = get_coder()->generate_register();
-                auto c = get_coder()->generate_register();
-
-                reg_t x = 0, y = 0;
-                int sz = aa.size();
-                for (int n = 1; n < sz; n++) {
-                    y = get_coder()->generate_register();
-                    if (n == 1) x = y;
+                if (get_state() == EMIT_EXPR && native_opcode(aa) >= 0) {
+                    emit_native(aa);
+                } else {
+                    emit_application(aa);
                 }
+                break;
+            }
+        }
+    }
 
-                // generate thunk label
-                auto t = get_coder()->generate_register();
+    // an application builds a thunk for the head and arguments, it becomes
+    // the continuation, and arguments are filled in or built the same way
+    void emit_application(const AstPtrs &aa) {
+        // generate labels rt, rti, k, exc, c, x .. y
+        auto rt = get_coder()->generate_register();
+        auto rti = get_coder()->generate_register();
+        auto k = get_coder()->generate_register();
+        auto exc = get_coder()->generate_register();
+        auto c = get_coder()->generate_register();
 
-                // fill rt, rti, k, exc, c, x .. y
-                get_coder()->emit_op_mov(rt, get_register_rt());
-                get_coder()->emit_op_mov(rti, get_register_rti());
-                get_coder()->emit_op_mov(k, get_register_k());
-                get_coder()->emit_op_mov(exc, get_register_exc());
+        reg_t x = 0, y = 0;
+        int sz = aa.size();
+        for (int n = 1; n < sz; n++) {
+            y = get_coder()->generate_register();
+            if (n == 1) x = y;
+        }
 
-                auto a = aa[0];
-                bool head_flag;  // generate more efficient code for vars and
-                                 // combinators
-                if (a->tag() == AST_EXPR_VARIABLE) {
-                    AST_EXPR_VARIABLE_SPLIT(a, p, n);
-                    auto r = get_variable_binding(n);
-                    get_coder()->emit_op_mov(c, r);
-                    head_flag = true;
-                } else if (a->tag() == AST_EXPR_COMBINATOR) {
-                    AST_EXPR_COMBINATOR_SPLIT(a, p, nn, n);
-                    auto v = machine()->get_combinator(nn, n);
-                    auto d = get_coder()->emit_data(v);
-                    get_coder()->emit_op_data(c, d);
-                    head_flag = true;
-                } else {
-                    get_coder()->emit_op_nil(c);
-                    head_flag = false;
-                }
+        // generate thunk label
+        auto t = get_coder()->generate_register();
+
+        // fill rt, rti, k, exc, c, x .. y
+        get_coder()->emit_op_mov(rt, get_register_rt());
+        get_coder()->emit_op_mov(rti, get_register_rti());
+        get_coder()->emit_op_mov(k, get_register_k());
+        get_coder()->emit_op_mov(exc, get_register_exc());
+
+        auto a = aa[0];
+        bool head_flag;  // generate more efficient code for vars and
+                         // combinators
+        if (a->tag() == AST_EXPR_VARIABLE) {
+            AST_EXPR_VARIABLE_SPLIT(a, p, n);
+            auto r = get_variable_binding(n);
+            get_coder()->emit_op_mov(c, r);
+            head_flag = true;
+        } else if (a->tag() == AST_EXPR_COMBINATOR) {
+            AST_EXPR_COMBINATOR_SPLIT(a, p, nn, n);
+            auto v = machine()->get_combinator(nn, n);
+            auto d = get_coder()->emit_data(v);
+            get_coder()->emit_op_data(c, d);
+            head_flag = true;
+        } else {
+            get_coder()->emit_op_nil(c);
+            head_flag = false;
+        }
 
-                reg_t z = x;
-                for (int n = 1; n < sz; n++) {
-                    get_coder()->emit_op_nil(z);
-                    z++;
-                }
-                get_coder()->emit_op_array(t, rt, y);
+        reg_t z = x;
+        for (int n = 1; n < sz; n++) {
+            get_coder()->emit_op_nil(z);
+            z++;
+        }
+        get_coder()->emit_op_array(t, rt, y);
 
-                // adjust for root
-                auto root = get_coder()->generate_register();
-                auto state = get_state();
-                if (state == EMIT_EXPR_ROOT) {
-                    set_state(EMIT_EXPR);
-                    auto f = get_register_frame();
+        // adjust for root
+        auto root = get_coder()->generate_register();
+        auto state = get_state();
+        if (state == EMIT_EXPR_ROOT) {
+            set_state(EMIT_EXPR);
+            auto f = get_register_frame();
 
-                    get_coder()->emit_op_concatx(root, t, f, 5 + get_arity());
-                } else {
-                    root = t;  // XXX: no mov?
-                }
-                k = root;
-                set_register_k(k);
-                rt = root;
-                set_register_rt(rt);
+            get_coder()->emit_op_concatx(root, t, f, 5 + get_arity());
+        } else {
+            root = t;  // XXX: no mov?
+        }
+        k = root;
+        set_register_k(k);
+        rt = root;
+        set_register_rt(rt);
 
-                // generate thunks for nil fields
-                if (!head_flag) {
-                    auto i = machine()->create_integer(4);
-                    auto d = get_coder()->emit_data(i);
-                    get_coder()->emit_op_data(rti, d);
+        // generate thunks for nil fields
+        if (!head_flag) {
+            auto i = machine()->create_integer(4);
+            auto d = get_coder()->emit_data(i);
+            get_coder()->emit_op_data(rti, d);
 
-                    set_register_rt(rt);
-                    set_register_rti(rti);
+            set_register_rt(rt);
+            set_register_rti(rti);
 
-                    visit(aa[0]);
-                }
+            visit(aa[0]);
+        }
 
-                for (int n = 1; n < sz; n++) {
-                    auto i = machine()->create_integer(n + 4);
-                    auto d = get_coder()->emit_data(i);
-                    reg_t q = get_coder()->generate_register();
-                    get_coder()->emit_op_data(q, d);
+        for (int n = 1; n < sz; n++) {
+            auto i = machine()->create_integer(n + 4);
+            auto d = get_coder()->emit_data(i);
+            reg_t q = get_coder()->generate_register();
+            get_coder()->emit_op_data(q, d);
 
-                    set_register_rt(rt);
-                    set_register_rti(q);
+            set_register_rt(rt);
+            set_register_rti(q);
 
-                    visit(aa[n]);
-                }
+            visit(aa[n]);
+        }
+    }
 
-                break;
+    // the opcode for a saturated arithmetic or comparison operator of
+    // System on variables and number literals, or -1
+    int native_opcode(const AstPtrs &aa) {
+        static const std::map<icu::UnicodeString, opcode_t> ops = {
+            {"System::+", OP_ADD}, {"System::-", OP_SUB},
+            {"System::*", OP_MUL}, {"System::<", OP_LT},
+            {"System::<=", OP_LE}, {"System::==", OP_EQ},
+        };
+
+        // operators are compiled out to combinators by now
+        if (aa.size() != 3 || aa[0]->tag() != AST_EXPR_COMBINATOR) return -1;
+        auto &a = aa[0];
+        AST_EXPR_COMBINATOR_SPLIT(a, p, nn, n);
+        auto o = ops.find(machine()->get_combinator(nn, n)->to_text());
+        if (o == ops.end()) return -1;
+        for (size_t i = 1; i < aa.size(); i++) {
+            auto t = aa[i]->tag();
+            if (t != AST_EXPR_VARIABLE && t != AST_EXPR_INTEGER &&
+                t != AST_EXPR_FLOAT) {
+                return -1;
             }
         }
+        return o->second;
+    }
+
+    // the register holding a variable, or a number literal loaded into one
+    reg_t native_operand(const AstPtr &a) {
+        if (a->tag() == AST_EXPR_VARIABLE) {
+            AST_EXPR_VARIABLE_SPLIT(a, p, n);
+            return get_variable_binding(n);
+        }
+        VMObjectPtr o;
+        if (a->tag() == AST_EXPR_INTEGER) {
+            AST_EXPR_INTEGER_SPLIT(a, p, v);
+            auto i = v.startsWith("0x") ? convert_to_hexint(v)
+                                        : convert_to_int(v);
+            o = machine()->create_integer(i);
+        } else {
+            AST_EXPR_FLOAT_SPLIT(a, p, v);
+            o = machine()->create_float(convert_to_float(v));
+        }
+        auto r = get_coder()->generate_register();
+        auto d = get_coder()->emit_data(o);
+        get_coder()->emit_op_data(r, d);
+        return r;
+    }
+
+    // compute the operator in place when the operands are numbers, and
+    // only otherwise build the thunk which applies the builtin
+    void emit_native(const AstPtrs &aa) {
+        auto op = (opcode_t)native_opcode(aa);
+        auto rt = get_register_rt();
+        auto rti = get_register_rti();
+        auto k = get_register_k();
+
+        auto y = native_operand(aa[1]);
+        auto z = native_operand(aa[2]);
+        auto x = get_coder()->generate_register();
+        auto kk = get_coder()->generate_register();
+        auto l = get_coder()->generate_label();
+        auto end = get_coder()->generate_label();
+
+        get_coder()->emit_op_native(op, x, y, z);
+        get_coder()->emit_op_fail(l);
+        get_coder()->emit_op_set(rt, rti, x);
+        get_coder()->emit_op_mov(kk, k);
+        get_coder()->emit_op_fail(end);  // a fail clears the flag, so jump
+
+        get_coder()->emit_label(l);
+        emit_application(aa);
+        get_coder()->emit_op_mov(kk, get_register_k());
+
+        get_coder()->emit_label(end);
+        set_register_rt(rt);
+        set_register_rti(rti);
+        set_register_k(kk);
     }
 
     void visit_expr_tag(const Position &p, const AstPtr &v,
@@ -505,11 +595,19 @@ public:
 
     void visit_expr_match(const Position &p, const AstPtrs &mm, const AstPtr &g,
                           const AstPtr &e) override {
+        auto l = get_coder()->generate_label();
+        emit_match(mm, e, l);
+
+        // generate a label at the end of the match
+        get_coder()->emit_label(l);
+    }
+
+    // a match which jumps to l when it fails
+    void emit_match(const AstPtrs &mm, const AstPtr &e, label_t l) {
         // we have memberberries
         auto member = get_coder()->peek_register();
         auto r = get_register_frame();
 
-        auto l = get_coder()->generate_label();
         set_fail_label(l);
 
         int arity = mm.size();
@@ -540,8 +638,6 @@ public:
         auto k = get_register_k();
         get_coder()->emit_op_return(k);
 
-        // generate a label at the end of the match
-        get_coder()->emit_label(l);
         get_coder()->restore_register(member);
     }
 
@@ -552,15 +648,149 @@ public:
         auto k = get_register_k();
         auto exc = get_register_exc();
 
-        for (auto &a : alts) {
+        auto restore = [&] {
             set_register_rt(rt);
             set_register_rti(rti);
             set_register_k(k);
             set_register_exc(exc);
-            visit(a);
+        };
+
+        int column = switch_column(alts);
+        if (column < 0) {
+            for (auto &a : alts) {
+                restore();
+                visit(a);
+            }
+        } else {
+            emit_switch(alts, column, restore);
+        }
+    }
+
+    // the data object a pattern must equal at its head, or nullptr when the
+    // pattern may match objects with any switch key
+    VMObjectPtr switch_pattern(const AstPtr &a) {
+        switch (a->tag()) {
+            case AST_EXPR_INTEGER: {
+                AST_EXPR_INTEGER_SPLIT(a, p, v);
+                auto i = v.startsWith("0x") ? convert_to_hexint(v)
+                                            : convert_to_int(v);
+                return machine()->create_integer(i);
+            }
+            case AST_EXPR_CHARACTER: {
+                AST_EXPR_CHARACTER_SPLIT(a, p, v);
+                return machine()->create_char(convert_to_char(v));
+            }
+            case AST_EXPR_COMBINATOR: {
+                AST_EXPR_COMBINATOR_SPLIT(a, p, nn, n);
+                return machine()->get_combinator(nn, n);
+            }
+            case AST_EXPR_OPERATOR: {
+                AST_EXPR_OPERATOR_SPLIT(a, p, nn, n);
+                return machine()->get_combinator(nn, n);
+            }
+            case AST_EXPR_APPLICATION: {
+                AST_EXPR_APPLICATION_SPLIT(a, p, aa);
+                auto h = aa[0]->tag();
+                if (h == AST_EXPR_COMBINATOR || h == AST_EXPR_OPERATOR) {
+                    return switch_pattern(aa[0]);
+                }
+                return nullptr;
+            }
+            default:
+                return nullptr;
         }
     }
 
+    // the argument a block of matches best dispatches on, or -1 when too
+    // few alternatives differ in any argument for a switch to pay off
+    int switch_column(const AstPtrs &alts) {
+        size_t arity = std::numeric_limits<size_t>::max();
+        for (auto &a : alts) {
+            if (a->tag() != AST_EXPR_MATCH) return -1;
+            AST_EXPR_MATCH_SPLIT(a, p, mm, g, e);
+            arity = std::min(arity, mm.size());
+        }
+        if (alts.empty()) return -1;
+
+        int column = -1;
+        size_t best = SWITCH_KEYS - 1;
+        for (size_t c = 0; c < arity; c++) {
+            std::set<uint64_t> keys;
+            for (auto &a : alts) {
+                AST_EXPR_MATCH_SPLIT(a, p, mm, g, e);
+                auto o = switch_pattern(mm[c]);
+                if (o != nullptr) keys.insert(switch_key(o));
+            }
+            if (keys.size() > best) {
+                column = c;
+                best = keys.size();
+            }
+        }
+        return column;
+    }
+
+    // alternatives are entered through a switch on the argument in column,
+    // and only ever tried for arguments with the key of their pattern. when
+    // an alternative with a key fails the next one to try is known, after
+    // one without a key the remaining alternatives switch again
+    void emit_switch(const AstPtrs &alts, int column,
+                     const std::function<void()> &restore) {
+        auto n = alts.size();
+        std::vector<VMObjectPtr> oo;
+        std::vector<uint64_t> kk;  // zero for any key
+        std::vector<label_t> ll;
+        for (auto &a : alts) {
+            AST_EXPR_MATCH_SPLIT(a, p, mm, g, e);
+            auto o = switch_pattern(mm[column]);
+            oo.push_back(o);
+            kk.push_back((o == nullptr) ? 0 : switch_key(o));
+            ll.push_back(get_coder()->generate_label());
+        }
+        auto end = get_coder()->generate_label();
+
+        // the first alternative from i on which may match key k
+        auto next = [&](size_t i, uint64_t k) {
+            for (; i < n; i++) {
+                if (kk[i] == 0 || kk[i] == k) return ll[i];
+            }
+            return end;
+        };
+
+        auto x = get_coder()->generate_register();
+        auto dispatch = [&](size_t i) {
+            Cases cc;
+            std::set<uint64_t> done;
+            for (auto j = i; j < n && kk[j] != 0; j++) {
+                if (done.insert(kk[j]).second) {
+                    cc.emplace_back(get_coder()->emit_data(oo[j]), ll[j]);
+                }
+            }
+            get_coder()->emit_op_switch(x, next(i, 0), cc);
+        };
+
+        get_coder()->emit_op_takex(x, x, get_register_frame(), 5 + column);
+        get_coder()->emit_op_fail(end);
+        dispatch(0);
+        for (size_t i = 0; i < n; i++) {
+            auto &a = alts[i];
+            AST_EXPR_MATCH_SPLIT(a, p, mm, g, e);
+            restore();
+            get_coder()->emit_label(ll[i]);
+            if (kk[i] != 0) {
+                emit_match(mm, e, next(i + 1, kk[i]));
+            } else if (i + 1 < n && kk[i + 1] != 0) {
+                auto l = get_coder()->generate_label();
+                emit_match(mm, e, l);
+                get_coder()->emit_label(l);
+                dispatch(i + 1);
+            } else {
+                emit_match(mm, e, next(i + 1, 0));
+            }
+        }
+        get_coder()->emit_label(end);
+        get_coder()->restore_register(x);
+    }
+
     void visit_expr_try(const Position &p, const AstPtr &t,
                         const AstPtr &c) override {
         auto rt = get_register_rt();
@@ -727,6 +957,9 @@ public:
     }
 
 private:
+    // alternatives must differ in this many keys for a switch to pay off
+    static constexpr size_t SWITCH_KEYS = 4;
+
     emit_state_t _state;
     VM *_machine;
 
@@ -17,7 +17,7 @@ public:
     }
 
     static VMObjectPtr create(VM *m, const symbol_t s, const callback_t call) {
-        return std::make_shared<EvalResult>(m, s, call);
+        return VMObjectPtr(new EvalResult(m, s, call));
     }
 
     callback_t callback() const {
@@ -25,7 +25,7 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = machine()->get_array(thunk);
+        auto tt = machine()->array_view(thunk);
         auto arg0 = tt[5];
 
         (_callback)(machine(), arg0);
@@ -59,14 +59,13 @@ public:
 
     static VMObjectPtr create(VM *m, const symbol_t s,
                               const VMReduceResult &r) {
-        return std::make_shared<VarCombinator>(m, s, r);
+        return VMObjectPtr(new VarCombinator(m, s, r));
     }
 
     static VMObjectPtr create(VM *vm, const VMObjectPtr &o,
                               const VMReduceResult &r) {
         if (o->tag() == VM_OBJECT_COMBINATOR) {
-            auto c = VM_OBJECT_COMBINATOR_CAST(o);
-            auto v = VarCombinator::create(vm, c->symbol(), r);
+            auto v = VarCombinator::create(vm, o->symbol(), r);
             return v;
         } else {
             throw ErrorInternal("failure to create Var");
@@ -78,7 +77,7 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = machine()->get_array(thunk);
+        auto tt = machine()->array_view(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <deque>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <map>
 #include <memory>
@@ -16,30 +21,58 @@
 #include "assembler.hpp"
 #include "eval.hpp"
 #include "modules.hpp"
+#include "pool.hpp"
 
+// symbols are looked up and read without a lock and entered under one.
+// The strings live in chunks which never move and the index is an open
+// addressing hash table which is replaced, never changed in place, when
+// it fills up. A slot packs a string's hash with its symbol, zero is an
+// empty slot.
 class SymbolTable {
 public:
-    SymbolTable()
-        : _to(std::vector<icu::UnicodeString>()),
-          _from(std::map<icu::UnicodeString, symbol_t>()) {
+    SymbolTable() {
+        _index.store(new index_t(INDEX_SIZE), std::memory_order_relaxed);
     }
 
-    SymbolTable(const SymbolTable &other) : _to(other._to), _from(other._from) {
+    SymbolTable(const SymbolTable &other) : SymbolTable() {
+        for (int n = 0; n < other.size(); n++) {
+            enter(other.get(n));
+        }
+    }
+
+    ~SymbolTable() {
+        for (auto &c : _chunks) {
+            delete[] c.load(std::memory_order_relaxed);
+        }
+        delete _index.load(std::memory_order_relaxed);
+        for (auto i : _retired) {
+            delete i;
+        }
     }
 
     bool member(const icu::UnicodeString &s) const {
-        return (_from.count(s) > 0);
+        symbol_t n;
+        return find(s, hash(s), n);
     }
 
     symbol_t enter(const icu::UnicodeString &s) {
-        if (_from.count(s) == 0) {
-            symbol_t n = _to.size();
-            _to.push_back(s);
-            _from[s] = n;
-            return n;
-        } else {
-            return _from[s];
+        auto h = hash(s);
+        symbol_t n;
+        if (find(s, h, n)) return n;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (find(s, h, n)) return n;
+        n = _size.load(std::memory_order_relaxed);
+        auto &e = allocate(n);
+        e.text = s;
+        e.hash = h;
+        auto i = _index.load(std::memory_order_relaxed);
+        if (2 * (n + 1) > i->size) {
+            i = grow(i);
         }
+        insert(i, h, n);
+        _size.store(n + 1, std::memory_order_release);
+        return n;
     }
 
     symbol_t enter(const icu::UnicodeString &n0, const icu::UnicodeString &n1) {
@@ -57,70 +90,169 @@ public:
     }
 
     int size() const {
-        return _to.size();
+        return _size.load(std::memory_order_acquire);
     }
 
-    icu::UnicodeString get(const symbol_t &s) {
-        return _to[s];
+    icu::UnicodeString get(const symbol_t &s) const {
+        return entry(s).text;
     }
 
-    void render(std::ostream &os) {
-        for (size_t t = 0; t < _to.size(); t++) {
-            os << std::setw(8) << t << "=" << _to[t] << std::endl;
+    void render(std::ostream &os) const {
+        for (int t = 0; t < size(); t++) {
+            os << std::setw(8) << t << "=" << entry(t).text << std::endl;
         }
     }
 
 private:
-    std::vector<icu::UnicodeString> _to;
-    std::map<icu::UnicodeString, symbol_t> _from;
+    struct entry_t {
+        icu::UnicodeString text;
+        uint32_t hash;
+    };
+
+    struct index_t {
+        explicit index_t(size_t n)
+            : size(n), slots(new std::atomic<uint64_t>[n]) {
+            for (size_t i = 0; i < n; i++) {
+                slots[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        size_t size;  // a power of two
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    // chunk k holds CHUNK_SIZE << k entries
+    static constexpr size_t CHUNK_SIZE = 256;
+    static constexpr size_t CHUNKS = 24;
+    static constexpr size_t INDEX_SIZE = 1024;
+
+    static uint32_t hash(const icu::UnicodeString &s) {
+        return static_cast<uint32_t>(s.hashCode());
+    }
+
+    static void locate(size_t n, size_t &chunk, size_t &offset) {
+        auto m = n / CHUNK_SIZE + 1;
+        chunk = std::bit_width(m) - 1;
+        offset = n - CHUNK_SIZE * ((size_t(1) << chunk) - 1);
+    }
+
+    const entry_t &entry(symbol_t n) const {
+        size_t chunk, offset;
+        locate(n, chunk, offset);
+        return _chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+    entry_t &allocate(symbol_t n) {
+        size_t chunk, offset;
+        locate(n, chunk, offset);
+        auto c = _chunks[chunk].load(std::memory_order_relaxed);
+        if (c == nullptr) {
+            c = new entry_t[CHUNK_SIZE << chunk];
+            _chunks[chunk].store(c, std::memory_order_release);
+        }
+        return c[offset];
+    }
+
+    // a reader holding a stale index may miss a recent symbol, it then
+    // finds it again under the lock
+    bool find(const icu::UnicodeString &s, uint32_t h, symbol_t &n) const {
+        auto i = _index.load(std::memory_order_acquire);
+        auto mask = i->size - 1;
+        for (auto k = h & mask;; k = (k + 1) & mask) {
+            auto v = i->slots[k].load(std::memory_order_acquire);
+            if (v == 0) return false;
+            if ((v >> 32) == h) {
+                n = static_cast<symbol_t>(v) - 1;
+                if (entry(n).text == s) return true;
+            }
+        }
+    }
+
+    static void insert(index_t *i, uint32_t h, symbol_t n) {
+        auto mask = i->size - 1;
+        auto k = h & mask;
+        while (i->slots[k].load(std::memory_order_relaxed) != 0) {
+            k = (k + 1) & mask;
+        }
+        i->slots[k].store((uint64_t(h) << 32) | (uint64_t(n) + 1),
+                          std::memory_order_release);
+    }
+
+    // rehash from the stored hashes, the old index stays valid for readers
+    index_t *grow(index_t *i) {
+        auto j = new index_t(2 * i->size);
+        auto n = _size.load(std::memory_order_relaxed);
+        for (symbol_t k = 0; k < n; k++) {
+            insert(j, entry(k).hash, k);
+        }
+        _index.store(j, std::memory_order_release);
+        _retired.push_back(i);
+        return j;
+    }
+
+    std::atomic<entry_t *> _chunks[CHUNKS] = {};
+    std::atomic<index_t *> _index;
+    std::atomic<symbol_t> _size = 0;
+    std::mutex _mutex;
+    std::vector<index_t *> _retired;
 };
 
+// redefinitions may run while other threads link their constants, the
+// table is locked
 class DataTable {
 public:
     DataTable() : _to(std::vector<VMObjectPtr>()) {
         // _from(std::map<VMObjectPtr, data_t, LessVMObjectPtr>()) {
     }
 
-    DataTable(const DataTable &other) : _to(other._to), _from(other._from) {
+    DataTable(const DataTable &other) {
+        std::lock_guard<std::mutex> lock(other._mutex);
+        _to = other._to;
+        _from = other._from;
     }
 
     void initialize() {
     }
 
     data_t enter(const VMObjectPtr &s) {
-        if (_from.count(s) == 0) {
-            data_t n = _to.size();
-            _to.push_back(s);
-            _from[s] = n;
-            return n;
-        } else {
-            return _from[s];
-        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return insert(s);
     }
 
     data_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _to.size();
     }
 
-    data_t define(const VMObjectPtr &s) {
-        if (_from.count(s) == 0) {
-            return enter(s);
+    // the entry a definition replaces is handed back in old, the key is
+    // replaced too so nothing keeps the old definition alive
+    data_t define(const VMObjectPtr &s, VMObjectPtr &old) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto i = _from.find(s);
+        if (i == _from.end()) {
+            return insert(s);
         } else {
-            data_t n = _from[s];
+            data_t n = i->second;
+            _from.erase(i);
+            _from[s] = n;
+            old = std::move(_to[n]);
             _to[n] = s;
             return n;
         }
     }
 
     VMObjectPtr get(const data_t &s) {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _to[s];
     }
 
     data_t get(const VMObjectPtr &o) {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _from[o];
     }
 
     void render(std::ostream &os) {
+        std::lock_guard<std::mutex> lock(_mutex);
         for (size_t t = 0; t < _to.size(); t++) {
             os << std::setw(8) << t << ":";
             _to[t]->debug(os);
@@ -129,8 +261,200 @@ public:
     }
 
 private:
+    data_t insert(const VMObjectPtr &s) {
+        auto i = _from.find(s);
+        if (i != _from.end()) return i->second;
+        data_t n = _to.size();
+        _to.push_back(s);
+        _from[s] = n;
+        return n;
+    }
+
     std::vector<VMObjectPtr> _to;
     std::map<VMObjectPtr, data_t, LessVMObjectPtr> _from;
+    mutable std::mutex _mutex;
+};
+
+/**
+ * Code resolves its constants into pools which don't count them, so the
+ * data entries a redefinition replaces, and the pools it outdates, are
+ * retired and freed only once no reducer can still be reading them.
+ *
+ * Reducers never hold on to a constant between reduction steps. There,
+ * every thread announces the epoch it sees, and every retirement bumps the
+ * epoch; what's retired is freed once all threads online have announced
+ * its epoch. A thread is offline while it's outside of the machine or
+ * waiting in the pool, so neither holds up reclamation.
+ * (Quiescent-state based reclamation, after McKenney.)
+ **/
+class Reclaimer {
+    struct alignas(64) thread_t {
+        std::atomic<uint64_t> epoch = 0;  // zero while offline
+        std::thread::id owner;
+        size_t depth = 0;
+    };
+
+public:
+    Reclaimer() : _id(_ids.fetch_add(1) + 1) {
+        VMThreadPool::parking(&Reclaimer::park);
+    }
+
+    ~Reclaimer() {
+        for (auto t : _threads) {
+            delete t;
+        }
+    }
+
+    // a reduction on this thread, the outermost one takes it online
+    class reducer_t {
+    public:
+        explicit reducer_t(Reclaimer &r)
+            : _reclaimer(r), _thread(r.local()), _outer(_current) {
+            if (_thread->depth++ == 0) r.online(_thread);
+            _current = this;
+        }
+
+        ~reducer_t() {
+            _current = _outer;
+            if (--_thread->depth == 0) _reclaimer.offline(_thread);
+        }
+
+        // between reduction steps
+        void quiescent() {
+            _reclaimer.quiescent(_thread);
+        }
+
+        void offline() {
+            _reclaimer.offline(_thread);
+        }
+
+        void online() {
+            _reclaimer.online(_thread);
+        }
+
+    private:
+        friend class Reclaimer;
+
+        Reclaimer &_reclaimer;
+        thread_t *_thread;
+        reducer_t *_outer;
+
+        static inline thread_local reducer_t *_current = nullptr;
+    };
+
+    void retire(const VMObjectPtr &o) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _limbo.push_back({_epoch.fetch_add(1) + 1, o, nullptr});
+            _retired++;
+        }
+        reclaim();
+    }
+
+    void retire(std::unique_ptr<uintptr_t[]> pool) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _limbo.push_back({_epoch.fetch_add(1) + 1, nullptr,
+                              std::move(pool)});
+            _retired++;
+        }
+        reclaim();
+    }
+
+private:
+    struct retired_t {
+        uint64_t epoch;
+        VMObjectPtr object;
+        std::unique_ptr<uintptr_t[]> pool;
+    };
+
+    struct cache_t {
+        uint64_t id = 0;
+        thread_t *thread = nullptr;
+    };
+
+    // the block of this thread, a thread reuses the block of an exited
+    // thread with the same id
+    thread_t *local() {
+        static thread_local cache_t c;
+        if (c.id == _id) return c.thread;
+        auto me = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(_mutex);
+        thread_t *t = nullptr;
+        for (auto u : _threads) {
+            if (u->owner == me) t = u;
+        }
+        if (t == nullptr) {
+            t = new thread_t();
+            t->owner = me;
+            _threads.push_back(t);
+        }
+        c.id = _id;
+        c.thread = t;
+        return t;
+    }
+
+    // coming online is ordered before the constants are read, the data
+    // epoch and the pools are loaded sequentially consistent
+    void online(thread_t *t) {
+        t->epoch.store(_epoch.load());
+    }
+
+    void offline(thread_t *t) {
+        t->epoch.store(0, std::memory_order_release);
+        reclaim();
+    }
+
+    // whoever sees the bumped epoch also sees what was retired unlinked
+    void quiescent(thread_t *t) {
+        auto e = _epoch.load(std::memory_order_acquire);
+        if (t->epoch.load(std::memory_order_relaxed) != e) announce(t, e);
+    }
+
+    // kept out of line, the check above runs on every reduction step
+    [[gnu::noinline]] void announce(thread_t *t, uint64_t e) {
+        t->epoch.store(e, std::memory_order_release);
+        reclaim();
+    }
+
+    // free what every thread online has seen retired, outside of the lock
+    void reclaim() {
+        if (_retired.load(std::memory_order_relaxed) == 0) return;
+        std::vector<retired_t> rr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto oldest = std::numeric_limits<uint64_t>::max();
+            for (auto t : _threads) {
+                auto e = t->epoch.load();
+                if (e != 0) oldest = std::min(oldest, e);
+            }
+            while (!_limbo.empty() && _limbo.front().epoch <= oldest) {
+                rr.push_back(std::move(_limbo.front()));
+                _limbo.pop_front();
+                _retired--;
+            }
+        }
+    }
+
+    // a thread waiting in the pool is offline
+    static void park(bool waiting) {
+        auto r = reducer_t::_current;
+        if (r == nullptr) return;
+        if (waiting) {
+            r->offline();
+        } else {
+            r->online();
+        }
+    }
+
+    const uint64_t _id;
+    std::atomic<uint64_t> _epoch = 1;
+    std::atomic<size_t> _retired = 0;
+    std::mutex _mutex;
+    std::vector<thread_t *> _threads;
+    std::deque<retired_t> _limbo;
+
+    static inline std::atomic<uint64_t> _ids = 0;
 };
 
 class VMObjectResult : public VMObjectCombinator {
@@ -150,10 +474,9 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
-        auto arg0 = tt[5];
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
 
-        _result->result = arg0;
+        _result->result = tt[5];
         _result->exception = _exception;
         return nullptr;
     }
@@ -227,6 +550,10 @@ public:
         ASSERT(VM_OBJECT_TUPLE_TEST(_tuple));
         ASSERT(VM_OBJECT_NIL_TEST(_nil));
         ASSERT(VM_OBJECT_CONS_TEST(_cons));
+
+        // continuations of reductions started from C++
+        _result = _symbols.enter("Internal", "result");
+        _exception = _symbols.enter("Internal", "exception");
     }
 
     // initialize
@@ -269,7 +596,13 @@ public:
     }
 
     data_t define_data(const VMObjectPtr &o) override {
-        return _data.define(o);
+        VMObjectPtr old;
+        auto d = _data.define(o, old);
+        if (old != nullptr) {
+            _data_epoch++;
+            _reclaimer.retire(old);
+        }
+        return d;
     }
 
     data_t get_data(const VMObjectPtr &o) override {
@@ -280,6 +613,14 @@ public:
         return _data.get(d);
     }
 
+    void retire(const VMObjectPtr &o) override {
+        _reclaimer.retire(o);
+    }
+
+    void retire(std::unique_ptr<uintptr_t[]> pool) override {
+        _reclaimer.retire(std::move(pool));
+    }
+
     // convenience
     VMObjectPtr get_combinator(const symbol_t s) override {
         auto o = VMObjectStub::create(this, s);
@@ -319,7 +660,7 @@ public:
         // define or overwrite
         auto s = o->to_text();  // XXX: usually works?
         enter_symbol(s);
-        enter_data(o);
+        define_data(o);
     }
 
     VMObjectPtr get(const VMObjectPtr &o) override {
@@ -329,7 +670,7 @@ public:
 
     // reduce an expression
     void reduce(const VMObjectPtr &f, const VMObjectPtr &ret,
-                const VMObjectPtr &exc, reducer_state_t *run) override {
+                const VMObjectPtr &exc, reducer_flag_t *run) override {
         VMObjectPtrs rr;
         rr.push_back(nullptr);  // rt
         rr.push_back(nullptr);  // rti
@@ -357,44 +698,56 @@ public:
         tt.push_back(f);  // c
         auto t = create_array(tt);
 
+        VMStats::timer_t timer;
+        auto stats = VMStats::enabled() ? &VMStats::local() : nullptr;
+        Reclaimer::reducer_t reducer(_reclaimer);
+
         auto trampoline = t;
-        while ((trampoline != nullptr) && (*run != HALTED)) {
-            if (*run == RUNNING) {
+        while (trampoline != nullptr) {
+            auto state = run->load(std::memory_order_relaxed);
+            if (state == RUNNING) {
+                reducer.quiescent();
                 ASSERT(trampoline->tag() == VM_OBJECT_ARRAY);
                 auto f = VM_OBJECT_ARRAY_CAST(trampoline)->get(4);
+                if (stats != nullptr) {
+                    VMStats::count_step(*stats, f->symbol());
+                    if (VMStats::tick(*stats)) {
+                        VMStats::sample(*stats, trampoline);
+                    }
+                }
 #ifdef DEBUG
                 std::cout << "trace: " << f << std::endl;
                 std::cout << "on : " << trampoline << std::endl;
 #endif
                 trampoline = f->reduce(trampoline);
-            } else if (*run == SLEEPING) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            } else {  // *run == HALTED
+            } else if (state == SLEEPING) {
+                reducer.offline();
+                run->wait(SLEEPING);
+                reducer.online();
+            } else {  // state == HALTED
+                break;
             }
         }
     }
 
     void reduce(const VMObjectPtr &f, const VMObjectPtr &ret,
                 const VMObjectPtr &exc) override {
-        reducer_state_t run = RUNNING;
+        reducer_flag_t run = RUNNING;
         reduce(f, ret, exc, &run);
     }
 
-    VMReduceResult reduce(const VMObjectPtr &f, reducer_state_t *run) override {
+    VMReduceResult reduce(const VMObjectPtr &f, reducer_flag_t *run) override {
         VMReduceResult r;
 
-        auto sm = enter_symbol("Internal", "result");
-        auto m = VMObjectResult::create(this, sm, &r, false);
-
-        auto se = enter_symbol("Internal", "exception");
-        auto e = VMObjectResult::create(this, se, &r, true);
+        auto m = VMObjectResult::create(this, _result, &r, false);
+        auto e = VMObjectResult::create(this, _exception, &r, true);
 
         reduce(f, m, e, run);
         return r;
     }
 
     VMReduceResult reduce(const VMObjectPtr &f) override {
-        reducer_state_t run = RUNNING;
+        reducer_flag_t run = RUNNING;
         return reduce(f, &run);
     }
 
@@ -447,7 +800,7 @@ public:
     }
 
     bool is_integer(const VMObjectPtr &o) override {
-        return o->tag() == VM_OBJECT_INTEGER;
+        return VM_OBJECT_INTEGER_TEST(o);
     }
 
     bool is_float(const VMObjectPtr &o) override {
@@ -455,7 +808,7 @@ public:
     }
 
     bool is_char(const VMObjectPtr &o) override {
-        return o->tag() == VM_OBJECT_CHAR;
+        return VM_OBJECT_CHAR_TEST(o);
     }
 
     bool is_text(const VMObjectPtr &o) override {
@@ -479,15 +832,15 @@ public:
     }
 
     VMObjectPtr create_none() override {
-        return get_data(SYMBOL_NONE);
+        return _none;
     }
 
     VMObjectPtr create_true() override {
-        return get_data(SYMBOL_TRUE);
+        return _true;
     }
 
     VMObjectPtr create_false() override {
-        return get_data(SYMBOL_FALSE);
+        return _false;
     }
 
     // predefined constants
@@ -567,6 +920,10 @@ public:
         return VM_OBJECT_ARRAY_VALUE(o);
     }
 
+    VMObjectPtrView array_view(const VMObjectPtr &o) override {
+        return VM_OBJECT_ARRAY_VIEW(o);
+    }
+
     bool is_combinator(const VMObjectPtr &o) override {
         return VM_OBJECT_COMBINATOR_TEST(o);
     }
@@ -744,6 +1101,15 @@ public:
         return create_array(tt);
     }
 
+    VMObjectPtr raise(const VMObjectPtr &e) override {
+        _raised = e;
+        return VMObjectPtr::raise_sentinel();
+    }
+
+    VMObjectPtr raised() override {
+        return std::move(_raised);
+    }
+
     VMObjectPtr to_tuple(const VMObjectPtrs &oo) override {
         VMObjectPtrs tt;
         tt.push_back(create_tuple());
@@ -758,7 +1124,7 @@ public:
         if (is_tuple(oo)) {
             return tt;
         } else if (is_array(oo)) {
-            auto tt1 = get_array(oo);
+            auto tt1 = array_view(oo);
             for (unsigned int n = 1; n < tt1.size(); n++) {
                 tt.push_back(tt1[n]);
             }
@@ -908,6 +1274,7 @@ public:
 private:
     SymbolTable _symbols;
     DataTable _data;
+    Reclaimer _reclaimer;
     void *_context;
     std::mutex _mutex;
 
@@ -924,7 +1291,13 @@ private:
     VMObjectPtr _cons;
     VMObjectPtr _tuple;
 
+    symbol_t _result;
+    symbol_t _exception;
+
     OptionsPtr _options;
     ModuleManagerPtr _manager;
     EvalPtr _eval;
+
+    // the pending exception of the reducer thread
+    static inline thread_local VMObjectPtr _raised;
 };
@@ -160,7 +160,7 @@ private:
 };
 
 class VMModule;
-using VMModulePtr = std::shared_ptr<VMModule>;
+using VMModulePtr = VMObjectRef<VMModule>;
 
 class VMModule : public Opaque {
 public:
@@ -175,7 +175,7 @@ public:
     }
 
     static VMObjectPtr create(VM *vm, ModulePtr p) {
-        return std::make_shared<VMModule>(vm, p);
+        return VMObjectPtr(new VMModule(vm, p));
     }
 
     ModulePtr value() const {
@@ -204,7 +204,7 @@ public:
     }
 
     static VMModulePtr module_cast(const VMObjectPtr &o) {
-        return std::static_pointer_cast<VMModule>(o);
+        return vm_object_cast<VMModule>(o);
     }
 
     VMObjectPtr name() {
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a deque; it pushes and pops its own work at the
+ * back while idle workers steal from the front of the others. Threads
+ * outside of the pool submit to a shared injection queue.
+ *
+ * A thread that joins a task doesn't block while there's pending work
+ * but helps out, starting with its own most recently submitted task.
+ * Nested joins therefore can't deadlock and never need more threads
+ * than the pool has workers.
+ *
+ * A task that throws keeps the exception, joining the task rethrows it
+ * on the joiner's thread.
+ *
+ * Process steps are marked as such. A thread waiting on a mailbox or a
+ * channel only helps out with those: an arbitrary task might wait on the
+ * very message the suspended caller was about to send. While it's blocked
+ * and every other thread is busy, a spare worker takes on the ordinary
+ * tasks instead. Spares are never more than the threads blocked at once,
+ * they stay on as extra workers.
+ *
+ * A thread may also keep a task back instead of submitting it, to run it
+ * in place later. Should the thread have to wait before then, it submits
+ * the tasks it kept back first.
+ *
+ * Once the pool is stopped a waiting thread throws out of its task rather
+ * than wait on work which will never run.
+ **/
+
+class VMTask {
+public:
+    explicit VMTask(std::function<void()> f, bool step = false)
+        : _work(std::move(f)), _step(step) {
+    }
+
+    static std::shared_ptr<VMTask> create(std::function<void()> f,
+                                          bool step = false) {
+        return std::make_shared<VMTask>(std::move(f), step);
+    }
+
+    bool step() const {
+        return _step;
+    }
+
+    void run() {
+        try {
+            _work();
+        } catch (...) {
+            _error = std::current_exception();
+        }
+        _work = nullptr;
+        _done.store(true);
+    }
+
+    bool done() const {
+        return _done.load();
+    }
+
+    // the exception the task threw, valid once it is done
+    std::exception_ptr error() const {
+        return _error;
+    }
+
+private:
+    std::function<void()> _work;
+    bool _step;
+    std::exception_ptr _error;
+    std::atomic<bool> _done = false;
+};
+
+using VMTaskPtr = std::shared_ptr<VMTask>;
+
+class VMThreadPool {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    // the number of workers, set before the pool is first used
+    static void workers(size_t n) {
+        _workers = std::max<size_t>(n, 1);
+    }
+
+    static size_t workers() {
+        if (_workers == 0) {
+            return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        } else {
+            return _workers;
+        }
+    }
+
+    // the pool is started on first use and lives until it is shut down
+    static VMThreadPool &get() {
+        auto p = _pool.load(std::memory_order_acquire);
+        if (p == nullptr) {
+            std::lock_guard<std::mutex> lock(_start);
+            p = _pool.load(std::memory_order_relaxed);
+            if (p == nullptr) {
+                p = new VMThreadPool(workers());
+                _pool.store(p, std::memory_order_release);
+            }
+        }
+        return *p;
+    }
+
+    // thrown out of a wait once the pool is stopped
+    struct stopped : std::exception {
+        const char *what() const noexcept override {
+            return "thread pool stopped";
+        }
+    };
+
+    // workers finish their current task and exit, queued tasks are dropped
+    // and waiting tasks are abandoned; call once no reducer uses the pool
+    // anymore. a worker still computing is left running, and the pool is
+    // left to it, since the process is about to exit; false then
+    static bool shutdown() {
+        std::lock_guard<std::mutex> lock(_start);
+        auto p = _pool.load();
+        if (p == nullptr) return true;
+        if (!p->stop()) return false;
+        _pool.store(nullptr);
+        delete p;
+        return true;
+    }
+
+    // no worker is idle and every worker already has a task waiting,
+    // submitting more only adds scheduling overhead
+    bool saturated() const {
+        return _idle == 0 && _pending >= _threads.size();
+    }
+
+    // keep 't' back on this thread, it's submitted when the thread waits
+    void defer(const VMTaskPtr &t) {
+        _deferred.push_back(t);
+    }
+
+    // take 't' back to run it in place, false when it was submitted
+    bool recall(const VMTaskPtr &t) {
+        auto i = std::find(_deferred.begin(), _deferred.end(), t);
+        if (i == _deferred.end()) return false;
+        _deferred.erase(i);
+        return true;
+    }
+
+    void submit(const VMTaskPtr &t) {
+        auto &q = (_index < _queues.size() - 1) ? *_queues[_index]
+                                                : *_queues.back();
+        _pending++;
+        if (t->step()) _steps++;
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(t);
+        }
+        if (_idle > 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _work_ready.notify_one();
+        } else if (_joiners > 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task_done.notify_all();
+        }
+    }
+
+    // run pending tasks until 't' is done, sleep only when there are none,
+    // then rethrow what 't' threw
+    void join(const VMTaskPtr &t) {
+        help([&t] { return t->done(); });
+        if (t->error() != nullptr) std::rethrow_exception(t->error());
+    }
+
+    // run pending tasks, or only process steps, until 'done' holds or the
+    // deadline passes; whoever makes it hold must call wake afterwards
+    bool help(const std::function<bool()> &done, bool steps = false,
+              const time_point &deadline = time_point::max()) {
+        VMTaskPtr o;
+        while (!done()) {
+            if (_stop) throw stopped();
+            if (pop(o, steps)) {
+                run(o);
+                if (deadline != time_point::max() &&
+                    std::chrono::steady_clock::now() >= deadline) {
+                    return done();
+                }
+                continue;
+            }
+            if (!_deferred.empty()) {
+                for (auto &t : _deferred) {
+                    submit(t);
+                }
+                _deferred.clear();
+                continue;
+            }
+            auto ready = [this, &done, steps] {
+                return done() || _stop || (steps ? _steps : _pending) > 0 ||
+                       (steps && starved());
+            };
+            bool timeout = false;
+            {
+                parked_t parked;
+                std::unique_lock<std::mutex> lock(_mutex);
+                _joiners++;
+                if (steps) {
+                    _blocked++;
+                    if (!_stop && starved()) spare();
+                }
+                if (_self != nullptr) _self->busy = false;
+                if (deadline == time_point::max()) {
+                    _task_done.wait(lock, ready);
+                } else {
+                    timeout = !_task_done.wait_until(lock, deadline, ready);
+                }
+                if (_self != nullptr) _self->busy = true;
+                if (steps) _blocked--;
+                _joiners--;
+            }
+            if (timeout) return false;
+        }
+        return true;
+    }
+
+    // 'f' hears when a thread starts and stops waiting in the pool
+    static void parking(void (*f)(bool)) {
+        _park.store(f, std::memory_order_relaxed);
+    }
+
+    void wake() {
+        // order the caller's change, which may be relaxed, before the check
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_joiners > 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task_done.notify_all();
+        }
+    }
+
+private:
+    struct queue_t {
+        std::mutex mutex;
+        std::deque<VMTaskPtr> tasks;
+    };
+
+    struct worker_t {
+        std::thread thread;
+        std::atomic<bool> busy = false;  // in a task and not waiting
+    };
+
+    explicit VMThreadPool(size_t n) {
+        for (size_t i = 0; i <= n; i++) {  // the last one is for injection
+            _queues.push_back(std::make_unique<queue_t>());
+        }
+        for (size_t i = 0; i < n; i++) {
+            _threads.push_back(start(i));
+        }
+    }
+
+    std::unique_ptr<worker_t> start(size_t i) {
+        auto w = std::make_unique<worker_t>();
+        w->thread = std::thread([this, w = w.get(), i] { work(w, i); });
+        return w;
+    }
+
+    // wake everyone, join the workers which aren't busy and let the others
+    // go; true when all were joined
+    bool stop() {
+        std::vector<worker_t *> joined;
+        std::vector<worker_t *> busy;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+            for (auto &w : _threads) {
+                (w->busy ? busy : joined).push_back(w.get());
+            }
+            for (auto &w : _spares) {
+                (w->busy ? busy : joined).push_back(w.get());
+            }
+        }
+        _work_ready.notify_all();
+        _task_done.notify_all();
+        for (auto w : joined) {
+            w->thread.join();
+        }
+        for (auto w : busy) {
+            w->thread.detach();
+        }
+        return busy.empty();
+    }
+
+    static bool take(queue_t &q, bool back, bool steps, VMTaskPtr &t) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        if (!steps) {
+            if (back) {
+                t = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                t = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            return true;
+        }
+        auto n = q.tasks.size();
+        for (size_t i = 0; i < n; i++) {
+            auto j = back ? n - 1 - i : i;
+            if (q.tasks[j]->step()) {
+                t = std::move(q.tasks[j]);
+                q.tasks.erase(q.tasks.begin() + j);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // own work last in first out, then injected work, then steal; for a
+    // thread outside of the pool the injection queue is its own, workers
+    // steal from its front
+    bool pop(VMTaskPtr &t, bool steps = false) {
+        if ((steps ? _steps : _pending) == 0) return false;
+
+        auto n = _queues.size() - 1;
+        bool found = false;
+        if (_index < n) found = take(*_queues[_index], true, steps, t);
+        if (!found) found = take(*_queues[n], _index >= n, steps, t);
+        for (size_t i = 1; !found && i <= n; i++) {
+            found = take(*_queues[(_index + i) % n], false, steps, t);
+        }
+        if (found) {
+            _pending--;
+            if (t->step()) _steps--;
+        }
+        return found;
+    }
+
+    struct parked_t {
+        parked_t() {
+            park(true);
+        }
+
+        ~parked_t() {
+            park(false);
+        }
+
+        static void park(bool waiting) {
+            auto f = _park.load(std::memory_order_relaxed);
+            if (f != nullptr) f(waiting);
+        }
+    };
+
+    static constexpr size_t MAX_SPARES = 256;
+
+    // ordinary tasks wait while no thread is free to run them, and another
+    // spare is allowed; call with the mutex held
+    bool starved() const {
+        return _idle == 0 && _pending > _steps &&
+               _spares.size() < std::min<size_t>(_blocked, MAX_SPARES);
+    }
+
+    // spares have no deque of their own, like threads outside of the pool
+    void spare() {
+        _spares.push_back(start(std::numeric_limits<size_t>::max()));
+    }
+
+    void run(VMTaskPtr &t) {
+        t->run();
+        t = nullptr;
+        wake();
+    }
+
+    // a worker which sees the stop drops the task it popped, otherwise
+    // stop sees it busy
+    void work(worker_t *w, size_t i) {
+        _self = w;
+        _index = i;
+        VMTaskPtr t;
+        while (!_stop) {
+            if (pop(t)) {
+                w->busy = true;
+                if (!_stop) run(t);
+                t = nullptr;
+                w->busy = false;
+            } else {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _idle++;
+                _work_ready.wait(lock,
+                                 [this] { return _pending > 0 || _stop; });
+                _idle--;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<queue_t>> _queues;
+    std::vector<std::unique_ptr<worker_t>> _threads;
+    std::vector<std::unique_ptr<worker_t>> _spares;  // guarded by the mutex
+
+    // counters are sequentially consistent: a sleeper registers itself
+    // before checking for work, a waker publishes work before checking
+    // for sleepers, so one of them always sees the other
+    std::atomic<size_t> _pending = 0;
+    std::atomic<size_t> _steps = 0;
+    std::atomic<size_t> _idle = 0;
+    std::atomic<size_t> _joiners = 0;
+    std::atomic<size_t> _blocked = 0;  // waiting on process steps
+    std::atomic<bool> _stop = false;
+    std::mutex _mutex;
+    std::condition_variable _work_ready;
+    std::condition_variable _task_done;
+
+    static inline std::atomic<VMThreadPool *> _pool = nullptr;
+    static inline std::atomic<void (*)(bool)> _park = nullptr;
+    static inline std::mutex _start;
+    static inline size_t _workers = 0;
+    static inline thread_local size_t _index =
+        std::numeric_limits<size_t>::max();
+    static inline thread_local worker_t *_self = nullptr;
+    static inline thread_local std::vector<VMTaskPtr> _deferred;
+};
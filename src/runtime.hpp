@@ -1,11 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <set>
+#include <span>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "unicode/uchar.h"
@@ -142,26 +151,742 @@ using symbol_t = uint32_t;
 using data_t = uint32_t;
 
 class VMObject;
-using VMObjectPtr = std::shared_ptr<VMObject>;
-using VMWeakObjectPtr = std::weak_ptr<VMObject>;
+class VMObjectPtr;
+
+/**
+ * Integers, chars, and the constants none, true, and false are unboxed.
+ *
+ * A VMObjectPtr either points to a heap object, or holds an immediate
+ * value in the pointer word itself. Heap objects are at least word aligned
+ * so the lowest bit distinguishes the two cases.
+ *
+ *    ...xxxxxx0  heap object
+ *    ...xxxxx01  integer (62 bits, signed)
+ *    ...xxxx011  char
+ *    ...xxxx111  constant (symbol of none, true, or false)
+ *    ...1111111  the raise sentinel (all bits set)
+ *
+ * The raise sentinel is returned by builtins which raise an exception
+ * without throwing, see VM::raise. It never escapes a reduction.
+ *
+ * Integers which don't fit in 62 bits are boxed as before.
+ **/
+const uintptr_t VM_IMMEDIATE_INTEGER = 0x1;
+const uintptr_t VM_IMMEDIATE_CHAR = 0x3;
+const uintptr_t VM_IMMEDIATE_CONSTANT = 0x7;
+const uintptr_t VM_IMMEDIATE_RAISE = ~((uintptr_t)0);
+
+const vm_int_t VM_IMMEDIATE_INTEGER_MAX = (((vm_int_t)1) << 61) - 1;
+const vm_int_t VM_IMMEDIATE_INTEGER_MIN = -(((vm_int_t)1) << 61);
+
+// a proxy materializes an immediate as a temporary object on the stack for
+// the duration of a member access, `o->render(os)` works for all objects
+class VMObjectProxy {
+public:
+    explicit VMObjectProxy(VMObject *o) : _object(o) {
+    }
+
+    // note: defined later in this header file once the literals are known
+    explicit VMObjectProxy(uintptr_t bits);
+
+    VMObjectProxy(const VMObjectProxy &) = delete;
+    VMObjectProxy &operator=(const VMObjectProxy &) = delete;
+
+    VMObject *operator->() const {
+        return _object;
+    }
+
+private:
+    VMObject *_object;
+    alignas(void *) unsigned char _storage[6 * sizeof(void *)];
+};
+
+// a counted reference to a heap object of a known class, the result of
+// vm_object_cast
+template <typename T>
+class VMObjectRef {
+public:
+    VMObjectRef() : _ptr(nullptr) {
+    }
+
+    VMObjectRef(std::nullptr_t) : _ptr(nullptr) {
+    }
+
+    explicit VMObjectRef(T *o) : _ptr(o) {
+        if (_ptr != nullptr) retain();
+    }
+
+    VMObjectRef(const VMObjectRef &o) : _ptr(o._ptr) {
+        if (_ptr != nullptr) retain();
+    }
+
+    VMObjectRef(VMObjectRef &&o) noexcept : _ptr(o._ptr) {
+        o._ptr = nullptr;
+    }
+
+    ~VMObjectRef() {
+        if (_ptr != nullptr) release();
+    }
+
+    VMObjectRef &operator=(const VMObjectRef &o) {
+        T *p = o._ptr;
+        if (p != nullptr) o.retain();
+        if (_ptr != nullptr) release();
+        _ptr = p;
+        return *this;
+    }
+
+    VMObjectRef &operator=(VMObjectRef &&o) noexcept {
+        T *p = o._ptr;
+        o._ptr = nullptr;
+        if (_ptr != nullptr) release();
+        _ptr = p;
+        return *this;
+    }
+
+    T *get() const {
+        return _ptr;
+    }
+
+    T *operator->() const {
+        return _ptr;
+    }
+
+    T &operator*() const {
+        return *_ptr;
+    }
+
+    explicit operator bool() const {
+        return _ptr != nullptr;
+    }
+
+    // hand over the reference to the caller
+    T *release_ownership() {
+        T *p = _ptr;
+        _ptr = nullptr;
+        return p;
+    }
+
+    friend bool operator==(const VMObjectRef &a, std::nullptr_t) {
+        return a._ptr == nullptr;
+    }
+
+    friend bool operator!=(const VMObjectRef &a, std::nullptr_t) {
+        return a._ptr != nullptr;
+    }
+
+private:
+    // note: defined later in this header file once VMObject is known
+    void retain() const;
+    void release();
+
+    T *_ptr;
+};
+
+class VMObjectPtr {
+public:
+    VMObjectPtr() : _ptr(nullptr) {
+    }
+
+    VMObjectPtr(std::nullptr_t) : _ptr(nullptr) {
+    }
+
+    explicit VMObjectPtr(VMObject *o) : _ptr(o) {
+        if (counted()) retain();
+    }
+
+    template <typename T>
+    VMObjectPtr(const VMObjectRef<T> &o) : VMObjectPtr(o.get()) {
+    }
+
+    template <typename T>
+    VMObjectPtr(VMObjectRef<T> &&o) : _ptr(o.release_ownership()) {
+    }
+
+    VMObjectPtr(const VMObjectPtr &o) : _ptr(o._ptr) {
+        if (counted()) retain();
+    }
+
+    VMObjectPtr(VMObjectPtr &&o) noexcept : _ptr(o._ptr) {
+        o._ptr = nullptr;
+    }
+
+    ~VMObjectPtr() {
+        if (counted()) release();
+    }
+
+    VMObjectPtr &operator=(const VMObjectPtr &o) {
+        VMObject *p = o._ptr;
+        if (o.counted()) o.retain();
+        if (counted()) release();
+        _ptr = p;
+        return *this;
+    }
+
+    VMObjectPtr &operator=(VMObjectPtr &&o) noexcept {
+        VMObject *p = o._ptr;
+        o._ptr = nullptr;
+        if (counted()) release();
+        _ptr = p;
+        return *this;
+    }
+
+    static bool fits_integer(const vm_int_t v) {
+        return (v >= VM_IMMEDIATE_INTEGER_MIN) &&
+               (v <= VM_IMMEDIATE_INTEGER_MAX);
+    }
+
+    static VMObjectPtr immediate_integer(const vm_int_t v) {
+        return VMObjectPtr((((uintptr_t)v) << 2) | VM_IMMEDIATE_INTEGER);
+    }
+
+    static VMObjectPtr immediate_char(const vm_char_t c) {
+        return VMObjectPtr((((uintptr_t)c) << 3) | VM_IMMEDIATE_CHAR);
+    }
+
+    static VMObjectPtr immediate_constant(const symbol_t s) {
+        return VMObjectPtr((((uintptr_t)s) << 3) | VM_IMMEDIATE_CONSTANT);
+    }
+
+    static VMObjectPtr raise_sentinel() {
+        return VMObjectPtr(VM_IMMEDIATE_RAISE);
+    }
+
+    bool is_immediate() const {
+        return (bits() & 0x1) != 0;
+    }
+
+    bool is_raise_sentinel() const {
+        return bits() == VM_IMMEDIATE_RAISE;
+    }
+
+    bool is_immediate_integer() const {
+        return (bits() & 0x3) == VM_IMMEDIATE_INTEGER;
+    }
+
+    bool is_immediate_char() const {
+        return (bits() & 0x7) == VM_IMMEDIATE_CHAR;
+    }
+
+    bool is_immediate_constant() const {
+        return (bits() & 0x7) == VM_IMMEDIATE_CONSTANT;
+    }
+
+    vm_int_t immediate_integer_value() const {
+        return ((vm_int_t)bits()) >> 2;
+    }
+
+    vm_char_t immediate_char_value() const {
+        return (vm_char_t)(bits() >> 3);
+    }
+
+    symbol_t immediate_constant_value() const {
+        return (symbol_t)(bits() >> 3);
+    }
+
+    VMObjectProxy operator->() const {
+        if (is_immediate()) {
+            return VMObjectProxy(bits());
+        } else {
+            return VMObjectProxy(_ptr);
+        }
+    }
+
+    explicit operator bool() const {
+        return _ptr != nullptr;
+    }
+
+    friend bool operator==(const VMObjectPtr &a0, const VMObjectPtr &a1) {
+        return a0._ptr == a1._ptr;
+    }
+
+    friend bool operator!=(const VMObjectPtr &a0, const VMObjectPtr &a1) {
+        return a0._ptr != a1._ptr;
+    }
+
+    friend bool operator==(const VMObjectPtr &a, std::nullptr_t) {
+        return a._ptr == nullptr;
+    }
+
+    friend bool operator!=(const VMObjectPtr &a, std::nullptr_t) {
+        return a._ptr != nullptr;
+    }
+
+    // an arbitrary total order for ordered containers
+    friend bool operator<(const VMObjectPtr &a0, const VMObjectPtr &a1) {
+        return a0.bits() < a1.bits();
+    }
+
+    // a word which refers to the object without counting, for holders that
+    // rely on something else to keep it alive, and a counted ref from it
+    uintptr_t uncounted() const {
+        return bits();
+    }
+
+    static VMObjectPtr from_uncounted(uintptr_t w) {
+        VMObjectPtr o(w);
+        if (o.counted()) o.retain();
+        return o;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const VMObjectPtr &a);
+
+    template <typename T>
+    friend VMObjectRef<T> vm_object_cast(const VMObjectPtr &o);
+
+private:
+    explicit VMObjectPtr(uintptr_t bits)
+        : _ptr(reinterpret_cast<VMObject *>(bits)) {
+    }
+
+    uintptr_t bits() const {
+        return reinterpret_cast<uintptr_t>(_ptr);
+    }
+
+    // only heap objects are counted
+    bool counted() const {
+        return (_ptr != nullptr) && !is_immediate();
+    }
+
+    // note: defined later in this header file once VMObject is known
+    void retain() const;
+    void release();
+
+    VMObject *_ptr;
+};
+
+// cast a heap object to its concrete class
+template <typename T>
+inline VMObjectRef<T> vm_object_cast(const VMObjectPtr &o) {
+    return VMObjectRef<T>(static_cast<T *>(o._ptr));
+}
 
 // forward declarations for pretty printing
 inline void render_tuple(const VMObjectPtr &tt, std::ostream &os);
 inline void render_nil(const VMObjectPtr &n, std::ostream &os);
 inline void render_cons(const VMObjectPtr &cc, std::ostream &os);
 
+// state shared by the host and every loaded .ego module. a module carries
+// its own copies of the statics in this header, so anything all copies must
+// agree on lives in the one instance the host exports as egel_runtime. it is
+// constant initialized, the stats registry is allocated once and never
+// freed since reducer threads may still use it while the process exits.
+struct VMStatsThread;
+
+struct VMRuntime {
+    std::atomic<bool> concurrent;  // reference counts are atomic
+    std::atomic<bool> pool;        // objects come from the pools
+    std::atomic<bool> stats;       // reductions are counted
+    std::mutex stats_mutex;        // guards stats_threads
+    std::vector<VMStatsThread *> *stats_threads;
+    uint64_t stats_interval;  // steps between profile samples
+    std::atomic<uint32_t> generations;  // machines created
+};
+
+// note: defined in egel.cpp, the only symbol the host exports to modules
+extern "C" VMRuntime egel_runtime;
+
+inline VMRuntime &vm_runtime() {
+    return egel_runtime;
+}
+
+// runtime objects are small and die young. they are allocated either with
+// the system allocator or, when selected at start-up, from thread local
+// pools of size classes. a block freed on another thread simply joins the
+// pool of that thread, surplus blocks move in batches through a shared
+// depot to the threads that need them.
+class VMAllocator {
+public:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_SIZE = 256;
+    static constexpr size_t CLASSES = MAX_SIZE / GRANULE;
+    static constexpr size_t BATCH = 64;
+    static constexpr size_t SLAB = 64 * 1024;
+
+    // select the pools, only before the first object is allocated
+    static void use_pool(bool b) {
+        vm_runtime().pool.store(b, std::memory_order_relaxed);
+    }
+
+    static bool pooled() {
+        return vm_runtime().pool.load(std::memory_order_relaxed);
+    }
+
+    static void *allocate(size_t sz) {
+        if (pooled() && sz <= MAX_SIZE) {
+            return pool_allocate(size_class(sz));
+        } else {
+            return ::operator new(sz);
+        }
+    }
+
+    static void deallocate(void *p, size_t sz) {
+        if (pooled() && sz <= MAX_SIZE) {
+            pool_deallocate(p, size_class(sz));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+private:
+    struct block_t {
+        block_t *next;
+        block_t *chain;  // next batch, in the depot
+    };
+
+    enum state_t : uint8_t {
+        POOL_FRESH,
+        POOL_OPEN,
+        POOL_CLOSED,
+    };
+
+    struct local_t {
+        block_t *_free[CLASSES];
+        uint32_t _count[CLASSES];
+        state_t _state;
+    };
+
+    struct reaper_t {
+        void touch() {
+        }
+
+        ~reaper_t() {
+            auto &l = _local;
+            for (size_t c = 0; c < CLASSES; c++) {
+                if (l._free[c] != nullptr) {
+                    push_depot(c, l._free[c]);
+                    l._free[c] = nullptr;
+                    l._count[c] = 0;
+                }
+            }
+            // blocks released by later destructors go to the depot
+            l._state = POOL_CLOSED;
+        }
+    };
+
+    static size_t size_class(size_t sz) {
+        return (sz + GRANULE - 1) / GRANULE - 1;
+    }
+
+    static void *pool_allocate(size_t c) {
+        auto &l = _local;
+        auto b = l._free[c];
+        if (b == nullptr) return refill(c);
+        l._free[c] = b->next;
+        l._count[c]--;
+        return b;
+    }
+
+    static void pool_deallocate(void *p, size_t c) {
+        auto &l = _local;
+        auto b = static_cast<block_t *>(p);
+        if (l._state != POOL_OPEN) {
+            if (l._state == POOL_CLOSED) {
+                b->next = nullptr;
+                push_depot(c, b);
+                return;
+            }
+            l._state = POOL_OPEN;
+            _reaper.touch();
+        }
+        b->next = l._free[c];
+        l._free[c] = b;
+        if (++l._count[c] >= 2 * BATCH) spill(c);
+    }
+
+    static void push_depot(size_t c, block_t *b) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        b->chain = _depot[c];
+        _depot[c] = b;
+    }
+
+    // move one batch of the local free list to the depot
+    static void spill(size_t c) {
+        auto &l = _local;
+        auto head = l._free[c];
+        auto last = head;
+        for (size_t n = 1; n < BATCH && last->next != nullptr; n++) {
+            last = last->next;
+        }
+        l._free[c] = last->next;
+        l._count[c] = (l._free[c] == nullptr) ? 0 : l._count[c] - BATCH;
+        last->next = nullptr;
+        push_depot(c, head);
+    }
+
+    // take a batch from the depot or carve a fresh slab, return one block
+    static void *refill(size_t c) {
+        auto &l = _local;
+        auto sz = (c + 1) * GRANULE;
+        if (l._state != POOL_OPEN) {
+            if (l._state == POOL_CLOSED) {
+                // a block of the full class size is valid in any pool
+                return ::operator new(sz);
+            }
+            l._state = POOL_OPEN;
+            _reaper.touch();
+        }
+
+        block_t *head = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            head = _depot[c];
+            if (head != nullptr) _depot[c] = head->chain;
+        }
+        if (head == nullptr) {
+            // slabs are never returned, blocks circulate between threads
+            auto slab = static_cast<char *>(::operator new(SLAB));
+            for (size_t n = 0; n + sz <= SLAB; n += sz) {
+                auto b = reinterpret_cast<block_t *>(slab + n);
+                b->next = head;
+                head = b;
+            }
+        }
+        // the count is a hint for spilling, batches may be short
+        l._free[c] = head->next;
+        l._count[c] = BATCH;
+        return head;
+    }
+
+    static inline constinit thread_local local_t _local = {};
+    static inline thread_local reaper_t _reaper;
+    static inline std::mutex _mutex;
+    static inline block_t *_depot[CLASSES] = {};
+};
+
+// reduction statistics, only kept when asked for with -S or -P. every thread
+// counts in its own block. blocks are never freed, an exiting thread hands
+// its block to the next thread that starts counting, so the counts of exited
+// threads remain available. counters are only written by their owner and
+// may be read by any thread.
+const size_t VM_OBJECT_KINDS = VM_OBJECT_ARRAY + 1;
+
+struct VMStatsThread {
+    uint64_t id;
+    std::thread::id owner;
+    std::atomic<uint64_t> steps;
+    std::atomic<uint64_t> opcodes;  // bytecode executed
+    std::atomic<uint64_t> exceptions;
+    std::atomic<uint64_t> wall;  // nanoseconds spent reducing
+    std::atomic<uint64_t> objects[VM_OBJECT_KINDS];
+    std::mutex mutex;                   // guards growing combinators
+    std::vector<uint64_t> combinators;  // invocations by symbol
+    uint32_t depth;                     // nested reductions
+    uint64_t countdown;                 // steps until the next sample
+    std::map<std::vector<symbol_t>, uint64_t> samples;  // by path
+};
+
+class VM;
+
+class VMStats {
+public:
+    using thread_t = VMStatsThread;
+
+    // start counting, set before reduction starts
+    static void enable() {
+        vm_runtime().stats.store(true, std::memory_order_relaxed);
+    }
+
+    static bool enabled() {
+        return vm_runtime().stats.load(std::memory_order_relaxed);
+    }
+
+    static thread_t &local() {
+        auto t = _local;
+        if (t == nullptr) t = enter();
+        return *t;
+    }
+
+    static void count_step(thread_t &t, symbol_t s) {
+        bump(t.steps);
+        if (s >= t.combinators.size()) grow(t, s);
+        std::atomic_ref<uint64_t> c(t.combinators[s]);
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    }
+
+    static void count_object(vm_tag_t k) {
+        if (!enabled()) return;
+        bump(local().objects[k]);
+    }
+
+    // objects materialized from immediates are not allocations, only
+    // called with counting enabled
+    static void uncount_object(vm_tag_t k) {
+        auto &c = local().objects[k];
+        c.store(c.load(std::memory_order_relaxed) - 1,
+                std::memory_order_relaxed);
+    }
+
+    static void count_opcodes(uint64_t n) {
+        if (!enabled()) return;
+        auto &c = local().opcodes;
+        c.store(c.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+    }
+
+    static void count_exception() {
+        if (!enabled()) return;
+        bump(local().exceptions);
+    }
+
+    // sample the reduction every n steps, set before reduction starts
+    static void profile(uint64_t n) {
+        vm_runtime().stats_interval = n;
+    }
+
+    // true when the thunk under reduction should be sampled
+    static bool tick(thread_t &t) {
+        return --t.countdown == 0;
+    }
+
+    // record the path of combinators along the continuation chain
+    // note: defined later in this header file once arrays are known
+    static void sample(thread_t &t, const VMObjectPtr &thunk);
+
+    // all samples in collapsed stack format, one path and count per line
+    static void render_profile(std::ostream &os, VM *vm);
+
+    // measures the wall time of the outermost reduction of a thread
+    class timer_t {
+    public:
+        timer_t() : _thread(enabled() ? &local() : nullptr) {
+            if (_thread != nullptr && _thread->depth++ == 0) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~timer_t() {
+            if (_thread != nullptr && --_thread->depth == 0) {
+                auto d = std::chrono::steady_clock::now() - _start;
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d);
+                _thread->wall.store(
+                    _thread->wall.load(std::memory_order_relaxed) + ns.count(),
+                    std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        thread_t *_thread;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // all counters as a json object
+    // note: defined later in this header file once the VM is known
+    static void render(std::ostream &os, VM *vm);
+
+private:
+    static void bump(std::atomic<uint64_t> &c) {
+        c.store(c.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    }
+
+    // the block of a thread goes back to the registry when it exits. the
+    // host and every module have a reaper, only the first finds the block
+    // still owned by the thread.
+    struct reaper_t {
+        void touch() {
+        }
+
+        ~reaper_t() {
+            auto &r = vm_runtime();
+            std::lock_guard<std::mutex> lock(r.stats_mutex);
+            if (_local != nullptr &&
+                _local->owner == std::this_thread::get_id()) {
+                _local->owner = std::thread::id();
+            }
+            // counts of later destructors go to a block nobody reads
+            static thread_t *closed = new thread_t();
+            _local = closed;
+        }
+    };
+
+    // the host and the modules each cache the block of a thread, the first
+    // to enter registers it and the others find it by its owner. a thread
+    // reuses the block of an exited thread before it adds one.
+    static thread_t *enter() {
+        _reaper.touch();
+        auto &r = vm_runtime();
+        auto me = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(r.stats_mutex);
+        if (r.stats_threads == nullptr) {
+            r.stats_threads = new std::vector<thread_t *>();
+        }
+        thread_t *free = nullptr;
+        for (auto t : *r.stats_threads) {
+            if (t->owner == me) {
+                _local = t;
+                return t;
+            }
+            if (free == nullptr && t->owner == std::thread::id()) free = t;
+        }
+        auto t = free;
+        if (t == nullptr) {
+            t = new thread_t();
+            t->id = r.stats_threads->size();
+            r.stats_threads->push_back(t);
+        }
+        t->owner = me;
+        t->depth = 0;
+        t->countdown =
+            (r.stats_interval == 0) ? UINT64_MAX : r.stats_interval;
+        _local = t;
+        return t;
+    }
+
+    static std::vector<thread_t *> threads() {
+        auto &r = vm_runtime();
+        std::lock_guard<std::mutex> lock(r.stats_mutex);
+        if (r.stats_threads == nullptr) return {};
+        return *r.stats_threads;
+    }
+
+    static void grow(thread_t &t, symbol_t s) {
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.combinators.resize(s + 1 + s / 2, 0);
+    }
+
+    static inline constinit thread_local thread_t *_local = nullptr;
+    static inline thread_local reaper_t _reaper;
+};
+
 class VMObject {
 public:
-    VMObject(const vm_tag_t t) : _tag(t), _subtag(0) {
+    VMObject(const vm_tag_t t) : _tag(t), _subtag(0), _refcount(0) {
+        VMStats::count_object(t);
+    }
+
+    VMObject(const vm_tag_t t, const vm_subtag_t st)
+        : _tag(t), _subtag(st), _refcount(0) {
+        VMStats::count_object(t);
     }
 
-    VMObject(const vm_tag_t t, const vm_subtag_t st) : _tag(t), _subtag(st) {
+    // copies are fresh objects and start uncounted
+    VMObject(const VMObject &o)
+        : _tag(o._tag), _subtag(o._subtag), _refcount(0) {
+        VMStats::count_object(o._tag);
     }
 
     virtual ~VMObject() {  // FIX: give a virtual destructor to keep the
                            // compiler(-s) happy
     }
 
+    static void *operator new(size_t sz) {
+        return VMAllocator::allocate(sz);
+    }
+
+    static void *operator new(size_t, void *p) noexcept {
+        return p;
+    }
+
+    // virtual destructors pass the size of the dynamic type
+    static void operator delete(void *p, size_t sz) {
+        VMAllocator::deallocate(p, sz);
+    }
+
+    static void operator delete(void *, void *) noexcept {
+    }
+
     vm_tag_t tag() const {
         return _tag;
     }
@@ -178,11 +903,6 @@ public:
         return _subtag == t;
     }
 
-    friend std::ostream &operator<<(std::ostream &os, const VMObjectPtr &a) {
-        a->render(os);
-        return os;
-    }
-
     virtual VMObjectPtr reduce(const VMObjectPtr &thunk) const = 0;
 
     virtual void render(std::ostream &os) const = 0;
@@ -198,12 +918,66 @@ public:
         return u;
     }
 
+    // reference counts are updated non-atomically until a second reducer
+    // thread is spawned, par and proc call this before they start threads
+    static void enter_concurrent() {
+        auto &c = vm_runtime().concurrent;
+        if (!c.load(std::memory_order_relaxed)) {
+            c.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    static bool concurrent() {
+        return vm_runtime().concurrent.load(std::memory_order_relaxed);
+    }
+
+    void inc_ref() const {
+        if (concurrent()) {
+            _refcount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _refcount.store(_refcount.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        }
+    }
+
+    // true if this was the last reference
+    bool dec_ref() const {
+        if (concurrent()) {
+            return _refcount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        } else {
+            auto n = _refcount.load(std::memory_order_relaxed) - 1;
+            _refcount.store(n, std::memory_order_relaxed);
+            return n == 0;
+        }
+    }
+
 private:
     vm_tag_t _tag;
     vm_subtag_t _subtag;
+    mutable std::atomic<uint32_t> _refcount;
 };
 
+inline void VMObjectPtr::retain() const {
+    _ptr->inc_ref();
+}
+
+inline void VMObjectPtr::release() {
+    if (_ptr->dec_ref()) delete _ptr;
+}
+
+template <typename T>
+inline void VMObjectRef<T>::retain() const {
+    _ptr->inc_ref();
+}
+
+template <typename T>
+inline void VMObjectRef<T>::release() {
+    if (_ptr->dec_ref()) delete _ptr;
+}
+
 using VMObjectPtrs = std::vector<VMObjectPtr>;
+// a borrowed view on a sequence of objects, valid while the owner lives
+using VMObjectPtrView = std::span<const VMObjectPtr>;
 using UnicodeStrings = std::vector<icu::UnicodeString>;
 
 // the virtual machine
@@ -376,8 +1150,14 @@ struct VMReduceResult {
     bool exception;
 };
 
+// a reducer runs, sleeps or is halted; processes use the same states to
+// tell whether they're scheduled, parked without work, or done
 enum reducer_state_t { RUNNING, SLEEPING, HALTED };
 
+// the state of a reducer is changed by other threads; a sleeping reducer
+// blocks until its state changes, setters should notify
+using reducer_flag_t = std::atomic<reducer_state_t>;
+
 class VM;
 using VMPtr = std::shared_ptr<VM>;
 
@@ -385,7 +1165,7 @@ using callback_t = std::function<void(VM *vm, const VMObjectPtr &)>;
 
 class VM {
 public:
-    VM(){};
+    VM() : _generation(next_generation()){};
 
     virtual ~VM(){
         // FIX: give a virtual destructor to keep the compiler(-s) happy
@@ -409,13 +1189,25 @@ public:
     virtual VMObjectPtr get_data(const data_t d) = 0;
     virtual data_t get_data(const VMObjectPtr &d) = 0;
 
+    // bumped whenever a data entry is redefined, code which resolved its
+    // constants under an older epoch links them again
+    uint64_t data_epoch() const {
+        return _data_epoch.load();
+    }
+
+    // code holds its constants without counting them, the replaced data
+    // entries and the pools a reducer may still read are retired instead
+    // of released
+    virtual void retire(const VMObjectPtr &o) = 0;
+    virtual void retire(std::unique_ptr<uintptr_t[]> pool) = 0;
+
     // reduce an expression
     virtual void reduce(const VMObjectPtr &e, const VMObjectPtr &ret,
-                        const VMObjectPtr &exc, reducer_state_t *run) = 0;
+                        const VMObjectPtr &exc, reducer_flag_t *run) = 0;
     virtual void reduce(const VMObjectPtr &e, const VMObjectPtr &ret,
                         const VMObjectPtr &exc) = 0;
     virtual VMReduceResult reduce(const VMObjectPtr &e,
-                                  reducer_state_t *run) = 0;
+                                  reducer_flag_t *run) = 0;
     virtual VMReduceResult reduce(const VMObjectPtr &e) = 0;
 
     // for threadsafe reductions we lock the vm and rely on C++ threadsafe
@@ -494,6 +1286,8 @@ public:
     virtual VMObjectPtr array_get(const VMObjectPtr &o, int n) = 0;
     virtual void array_set(VMObjectPtr &o, int n, const VMObjectPtr &e) = 0;
     virtual VMObjectPtrs get_array(const VMObjectPtr &o) = 0;
+    // borrowed view on the elements, only valid while o is alive
+    virtual VMObjectPtrView array_view(const VMObjectPtr &o) = 0;
 
     virtual bool is_combinator(const VMObjectPtr &o) = 0;
     virtual bool is_opaque(const VMObjectPtr &o) = 0;
@@ -604,6 +1398,52 @@ public:
     virtual VMObjectPtr bad_args(const VMObject *o, const VMObjectPtr &a0,
                                  const VMObjectPtr &a1,
                                  const VMObjectPtr &a2) = 0;
+
+    // builtins raise an exception e by returning raise(e) instead of
+    // throwing it, the combinator base classes pick it up with raised
+    virtual VMObjectPtr raise(const VMObjectPtr &e) = 0;
+    virtual VMObjectPtr raised() = 0;
+
+    // tells machines apart, unlike their addresses which may be reused
+    uint32_t generation() const {
+        return _generation;
+    }
+
+protected:
+    std::atomic<uint64_t> _data_epoch = 1;
+
+private:
+    static uint32_t next_generation() {
+        auto &g = vm_runtime().generations;
+        return g.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    const uint32_t _generation;
+};
+
+// a symbol a builtin resolves once instead of on every call, like
+//   static VMSymbol sym("System", "process");
+//   if (o->symbol() == sym(machine())) ...
+// the symbol of the last machine to ask is kept with the generation of that
+// machine in one word, generation zero is no machine
+class VMSymbol {
+public:
+    VMSymbol(const char *n0, const char *n1) : _n0(n0), _n1(n1) {
+    }
+
+    symbol_t operator()(VM *vm) {
+        auto c = _cache.load(std::memory_order_relaxed);
+        if ((c >> 32) == vm->generation()) return static_cast<symbol_t>(c);
+        auto s = vm->enter_symbol(_n0, _n1);
+        _cache.store((static_cast<uint64_t>(vm->generation()) << 32) | s,
+                     std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    const char *_n0;
+    const char *_n1;
+    std::atomic<uint64_t> _cache = 0;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -634,7 +1474,11 @@ public:
     }
 
     static VMObjectPtr create(const vm_int_t v) {
-        return std::make_shared<VMObjectInteger>(v);
+        if (VMObjectPtr::fits_integer(v)) {
+            return VMObjectPtr::immediate_integer(v);
+        } else {
+            return VMObjectPtr(new VMObjectInteger(v));
+        }
     }
 
     symbol_t symbol() const override {
@@ -653,11 +1497,23 @@ private:
     vm_int_t _value;
 };
 
-using VMObjectIntegerPtr = std::shared_ptr<VMObjectInteger>;
-#define VM_OBJECT_IS_INTEGER(a) (a->tag() == VM_OBJECT_INTEGER)
-#define VM_OBJECT_INTEGER_TEST(a) (a->tag() == VM_OBJECT_INTEGER)
-#define VM_OBJECT_INTEGER_CAST(a) std::static_pointer_cast<VMObjectInteger>(a)
-#define VM_OBJECT_INTEGER_VALUE(a) (VM_OBJECT_INTEGER_CAST(a)->value())
+inline bool vm_object_integer_test(const VMObjectPtr &a) {
+    return a.is_immediate_integer() ||
+           (!a.is_immediate() && (a->tag() == VM_OBJECT_INTEGER));
+}
+
+inline vm_int_t vm_object_integer_value(const VMObjectPtr &a) {
+    if (a.is_immediate()) {
+        return a.immediate_integer_value();
+    } else {
+        return vm_object_cast<VMObjectInteger>(a)->value();
+    }
+}
+
+// note: integers may be immediates, there is no cast to VMObjectInteger
+#define VM_OBJECT_IS_INTEGER(a) (vm_object_integer_test(a))
+#define VM_OBJECT_INTEGER_TEST(a) (vm_object_integer_test(a))
+#define VM_OBJECT_INTEGER_VALUE(a) (vm_object_integer_value(a))
 
 class VMObjectFloat : public VMObjectLiteral {
 public:
@@ -668,7 +1524,7 @@ public:
     }
 
     static VMObjectPtr create(const vm_float_t f) {
-        return std::make_shared<VMObjectFloat>(f);
+        return VMObjectPtr(new VMObjectFloat(f));
     }
 
     symbol_t symbol() const override {
@@ -690,9 +1546,9 @@ private:
     vm_float_t _value;
 };
 
-using VMObjectFloatPtr = std::shared_ptr<VMObjectFloat>;
+using VMObjectFloatPtr = VMObjectRef<VMObjectFloat>;
 #define VM_OBJECT_FLOAT_TEST(a) (a->tag() == VM_OBJECT_FLOAT)
-#define VM_OBJECT_FLOAT_CAST(a) std::static_pointer_cast<VMObjectFloat>(a)
+#define VM_OBJECT_FLOAT_CAST(a) vm_object_cast<VMObjectFloat>(a)
 #define VM_OBJECT_FLOAT_SPLIT(a, v)      \
     auto _##a = VM_OBJECT_FLOAT_CAST(a); \
     auto v = _##a->value();
@@ -707,7 +1563,7 @@ public:
     }
 
     static VMObjectPtr create(const vm_char_t v) {
-        return std::make_shared<VMObjectChar>(v);
+        return VMObjectPtr::immediate_char(v);
     }
 
     symbol_t symbol() const override {
@@ -728,13 +1584,23 @@ private:
     vm_char_t _value;
 };
 
-using VMObjectCharPtr = std::shared_ptr<VMObjectChar>;
-#define VM_OBJECT_CHAR_TEST(a) (a->tag() == VM_OBJECT_CHAR)
-#define VM_OBJECT_CHAR_CAST(a) std::static_pointer_cast<VMObjectChar>(a)
-#define VM_OBJECT_CHAR_SPLIT(a, v)      \
-    auto _##a = VM_OBJECT_CHAR_CAST(a); \
-    auto v = _##a->value();
-#define VM_OBJECT_CHAR_VALUE(a) (VM_OBJECT_CHAR_CAST(a)->value())
+inline bool vm_object_char_test(const VMObjectPtr &a) {
+    return a.is_immediate_char() ||
+           (!a.is_immediate() && (a->tag() == VM_OBJECT_CHAR));
+}
+
+inline vm_char_t vm_object_char_value(const VMObjectPtr &a) {
+    if (a.is_immediate()) {
+        return a.immediate_char_value();
+    } else {
+        return vm_object_cast<VMObjectChar>(a)->value();
+    }
+}
+
+// note: chars may be immediates, there is no cast to VMObjectChar
+#define VM_OBJECT_CHAR_TEST(a) (vm_object_char_test(a))
+#define VM_OBJECT_CHAR_SPLIT(a, v) auto v = vm_object_char_value(a);
+#define VM_OBJECT_CHAR_VALUE(a) (vm_object_char_value(a))
 
 class VMObjectText : public VMObjectLiteral {
 public:
@@ -749,11 +1615,11 @@ public:
     }
 
     static VMObjectPtr create(const icu::UnicodeString &v) {
-        return std::make_shared<VMObjectText>(v);
+        return VMObjectPtr(new VMObjectText(v));
     }
 
     static VMObjectPtr create(const char *v) {
-        return std::make_shared<VMObjectText>(v);
+        return VMObjectPtr(new VMObjectText(v));
     }
 
     symbol_t symbol() const override {
@@ -782,84 +1648,206 @@ private:
     icu::UnicodeString _value;
 };
 
-using VMObjectTextPtr = std::shared_ptr<VMObjectText>;
+using VMObjectTextPtr = VMObjectRef<VMObjectText>;
 #define VM_OBJECT_TEXT_TEST(a) (a->tag() == VM_OBJECT_TEXT)
-#define VM_OBJECT_TEXT_CAST(a) std::static_pointer_cast<VMObjectText>(a)
+#define VM_OBJECT_TEXT_CAST(a) vm_object_cast<VMObjectText>(a)
 #define VM_OBJECT_TEXT_SPLIT(a, v)      \
     auto _##a = VM_OBJECT_TEXT_CAST(a); \
     auto v = _##a->value();
 #define VM_OBJECT_TEXT_VALUE(a) (VM_OBJECT_TEXT_CAST(a)->value())
 
+// thunk frames and the result arrays they write into die almost as soon as
+// the trampoline advances. freed array blocks are kept per thread in free
+// lists bucketed by slot count and handed out again by the next allocation
+// of the same size.
+struct VMFrameStats {
+    uint64_t reused;
+    uint64_t allocated;
+};
+
+class VMFrameCache {
+public:
+    static constexpr size_t MAX_SLOTS = 16;
+    static constexpr size_t MAX_DEPTH = 1024;
+
+    // a block of n slots, or nullptr when the caller should allocate
+    static void *get(size_t n) {
+        auto &c = _local;
+        if (n < MAX_SLOTS) {
+            auto b = c._free[n];
+            if (b != nullptr) {
+                c._free[n] = b->next;
+                c._depth[n]--;
+                c._reused++;
+                return b;
+            }
+        }
+        c._allocated++;
+        return nullptr;
+    }
+
+    // keep a block of n slots, false when the caller should free it
+    static bool put(void *p, size_t n) {
+        auto &c = _local;
+        if (n < MAX_SLOTS && c._depth[n] < MAX_DEPTH) {
+            if (c._state != CACHE_OPEN) {
+                if (c._state == CACHE_CLOSED) return false;
+                c._state = CACHE_OPEN;
+                _reaper.touch();
+            }
+            auto b = static_cast<block_t *>(p);
+            b->next = c._free[n];
+            c._free[n] = b;
+            c._depth[n]++;
+            return true;
+        }
+        return false;
+    }
+
+    // counts of exited threads plus those of the calling thread
+    static VMFrameStats stats() {
+        auto &c = _local;
+        return {_retired_reused.load(std::memory_order_relaxed) + c._reused,
+                _retired_allocated.load(std::memory_order_relaxed) +
+                    c._allocated};
+    }
+
+private:
+    struct block_t {
+        block_t *next;
+    };
+
+    // the cache itself is trivially destructible to keep thread local
+    // access cheap, the reaper returns its blocks when a thread exits
+    struct reaper_t {
+        void touch() {
+        }
+
+        ~reaper_t();
+    };
+
+    enum state_t : uint8_t {
+        CACHE_FRESH,
+        CACHE_OPEN,
+        CACHE_CLOSED,
+    };
+
+    struct local_t {
+        block_t *_free[MAX_SLOTS];
+        uint32_t _depth[MAX_SLOTS];
+        uint64_t _reused;
+        uint64_t _allocated;
+        state_t _state;
+    };
+
+    static inline constinit thread_local local_t _local = {};
+    static inline thread_local reaper_t _reaper;
+    static inline std::atomic<uint64_t> _retired_reused = 0;
+    static inline std::atomic<uint64_t> _retired_allocated = 0;
+};
+
+// arrays are a header followed by their slots, allocated in one block
 class VMObjectArray : public VMObject {
 public:
-    VMObjectArray() : VMObject(VM_OBJECT_ARRAY), _value(VMObjectPtrs()){};
+    VMObjectArray(const VMObjectArray &l) = delete;
 
-    VMObjectArray(const VMObjectPtrs &v)
-        : VMObject(VM_OBJECT_ARRAY), _value(v){};
+    ~VMObjectArray() {
+        auto vv = slots();
+        for (uint32_t n = 0; n < _size; n++) {
+            vv[n].~VMObjectPtr();
+        }
+    }
 
-    VMObjectArray(const VMObjectArray &l) : VMObjectArray(l.value()) {
+    // the block is allocated by allocate and returned to the frame cache,
+    // the destroying delete still knows the size
+    static void operator delete(VMObjectArray *p, std::destroying_delete_t) {
+        auto size = p->_size;
+        p->~VMObjectArray();
+        if (!VMFrameCache::put(p, size)) {
+            VMAllocator::deallocate(p, block_size(size));
+        }
     }
 
-    VMObjectArray(const int size)
-        : VMObject(VM_OBJECT_ARRAY), _value(VMObjectPtrs(size)) {
+    static size_t block_size(size_t size) {
+        return sizeof(VMObjectArray) + size * sizeof(VMObjectPtr);
     }
 
     VMObjectPtr clone() const {
-        return std::make_shared<VMObjectArray>(*this);
+        auto aa = allocate(_size);
+        for (uint32_t n = 0; n < _size; n++) {
+            aa->slots()[n] = slots()[n];
+        }
+        return VMObjectPtr(aa);
     }
 
     static VMObjectPtr create(int size) {
-        return std::make_shared<VMObjectArray>(size);
+        return VMObjectPtr(allocate(size));
     }
 
     static VMObjectPtr create(const VMObjectPtrs &pp) {
-        if (pp.size() == 1) {
-            return pp[0];
-        } else {
-            return std::make_shared<VMObjectArray>(pp);
-        }
+        return create(pp.data(), pp.size());
     }
 
     static VMObjectPtr create(const VMObjectPtr *pp, size_t sz) {
         if (sz == 1) {
             return pp[0];
         } else {
-            auto aa = std::static_pointer_cast<VMObjectArray>(create(sz));
+            auto aa = allocate(sz);
             for (size_t n = 0; n < sz; n++) {
-                aa->set(n, pp[n]);
+                aa->slots()[n] = pp[n];
             }
-            return aa;
+            return VMObjectPtr(aa);
+        }
+    }
+
+    static VMObjectPtr create(const VMObjectPtrView &vv) {
+        return create(vv.data(), vv.size());
+    }
+
+    // an array of head followed by tail, used for building continuations
+    // and returning spurious arguments without intermediate vectors
+    static VMObjectPtr create(const VMObjectPtrView &head,
+                              const VMObjectPtrView &tail) {
+        auto aa = allocate(head.size() + tail.size());
+        auto vv = aa->slots();
+        for (size_t n = 0; n < head.size(); n++) {
+            vv[n] = head[n];
+        }
+        for (size_t n = 0; n < tail.size(); n++) {
+            vv[head.size() + n] = tail[n];
         }
+        return VMObjectPtr(aa);
+    }
+
+    static VMObjectPtr create(const VMObjectPtr &head,
+                              const VMObjectPtrView &tail) {
+        return create(VMObjectPtrView(&head, 1), tail);
     }
 
     symbol_t symbol() const override {
-        return _value[0]->symbol();
+        return slots()[0]->symbol();
     }
 
     size_t size() const {
-        return _value.size();
+        return _size;
     }
 
     VMObjectPtr &operator[](const size_t i) {
-        return _value[i];
+        return slots()[i];
     }
 
     const VMObjectPtr &operator[](const size_t i) const {
-        return _value[i];
+        return slots()[i];
     }
 
     // deprecate
     VMObjectPtr get(unsigned int i) const {
-        return _value[i];
+        return slots()[i];
     }
 
     // deprecate
     void set(unsigned int i, const VMObjectPtr &o) {
-        _value[i] = o;
-    }
-
-    void push_back(const VMObjectPtr &o) {
-        _value.push_back(o);
+        slots()[i] = o;
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override;
@@ -869,15 +1857,15 @@ public:
     }
 
     void render(std::ostream &os) const override {
-        auto head = value()[0];
-        if (head->symbol() == SYMBOL_TUPLE) {
-            render_tuple(this->clone(), os);
-        } else if ((head->symbol() == SYMBOL_CONS) && (value().size() == 3)) {
-            render_cons(this->clone(), os);
+        auto head = slots()[0]->symbol();
+        if (head == SYMBOL_TUPLE) {
+            render_tuple(VMObjectPtr(const_cast<VMObjectArray *>(this)), os);
+        } else if ((head == SYMBOL_CONS) && (_size == 3)) {
+            render_cons(VMObjectPtr(const_cast<VMObjectArray *>(this)), os);
         } else {
             os << '(';
             bool first = true;
-            for (auto &v : value()) {
+            for (auto &v : view()) {
                 if (first) {
                     first = false;
                 } else {
@@ -894,20 +1882,188 @@ public:
     }
 
     VMObjectPtrs value() const {
-        return _value;
+        return VMObjectPtrs(slots(), slots() + _size);
+    }
+
+    VMObjectPtrView view() const {
+        return VMObjectPtrView(slots(), _size);
     }
 
 private:
-    VMObjectPtrs _value;
+    VMObjectArray(const uint32_t size) : VMObject(VM_OBJECT_ARRAY), _size(size) {
+        auto vv = slots();
+        for (uint32_t n = 0; n < _size; n++) {
+            new (&vv[n]) VMObjectPtr();
+        }
+    }
+
+    static VMObjectArray *allocate(size_t size) {
+        auto p = VMFrameCache::get(size);
+        if (p == nullptr) {
+            p = VMAllocator::allocate(block_size(size));
+        }
+        return new (p) VMObjectArray((uint32_t)size);
+    }
+
+    VMObjectPtr *slots() {
+        return reinterpret_cast<VMObjectPtr *>(this + 1);
+    }
+
+    const VMObjectPtr *slots() const {
+        return reinterpret_cast<const VMObjectPtr *>(this + 1);
+    }
+
+    uint32_t _size;
 };
 
-using VMObjectArrayPtr = std::shared_ptr<VMObjectArray>;
+using VMObjectArrayPtr = VMObjectRef<VMObjectArray>;
+
+inline VMFrameCache::reaper_t::~reaper_t() {
+    auto &c = _local;
+    for (size_t n = 0; n < MAX_SLOTS; n++) {
+        while (c._free[n] != nullptr) {
+            auto b = c._free[n];
+            c._free[n] = b->next;
+            VMAllocator::deallocate(b, VMObjectArray::block_size(n));
+        }
+        c._depth[n] = 0;
+    }
+    _retired_reused += c._reused;
+    _retired_allocated += c._allocated;
+    c._reused = 0;
+    c._allocated = 0;
+    // objects released by later destructors are freed directly
+    c._state = CACHE_CLOSED;
+}
+static_assert(sizeof(VMObjectArray) % alignof(VMObjectPtr) == 0);
+
 #define VM_OBJECT_ARRAY_TEST(a) (a->tag() == VM_OBJECT_ARRAY)
-#define VM_OBJECT_ARRAY_CAST(a) std::static_pointer_cast<VMObjectArray>(a)
+#define VM_OBJECT_ARRAY_CAST(a) vm_object_cast<VMObjectArray>(a)
 #define VM_OBJECT_ARRAY_SPLIT(a, v)      \
     auto _##a = VM_OBJECT_ARRAY_CAST(a); \
     auto v = _##a->value();
 #define VM_OBJECT_ARRAY_VALUE(a) (VM_OBJECT_ARRAY_CAST(a)->value())
+// a view does not copy and is only valid while a is alive
+#define VM_OBJECT_ARRAY_VIEW(a) (VM_OBJECT_ARRAY_CAST(a)->view())
+
+inline void VMStats::render(std::ostream &os, VM *vm) {
+    static const char *kinds[VM_OBJECT_KINDS] = {
+        "integer", "float", "char", "text", "opaque", "combinator", "array",
+    };
+
+    auto quote = [](const icu::UnicodeString &u) {
+        std::string s;
+        u.toUTF8String(s);
+        std::string q = "\"";
+        for (auto c : s) {
+            if (c == '"' || c == '\\') q += '\\';
+            q += c;
+        }
+        return q + "\"";
+    };
+    auto load = [](const std::atomic<uint64_t> &c) {
+        return c.load(std::memory_order_relaxed);
+    };
+
+    auto tt = threads();
+
+    uint64_t steps = 0;
+    uint64_t opcodes = 0;
+    uint64_t exceptions = 0;
+    uint64_t objects[VM_OBJECT_KINDS] = {};
+    std::vector<uint64_t> combinators;
+    for (auto t : tt) {
+        steps += load(t->steps);
+        opcodes += load(t->opcodes);
+        exceptions += load(t->exceptions);
+        for (size_t k = 0; k < VM_OBJECT_KINDS; k++) {
+            objects[k] += load(t->objects[k]);
+        }
+        std::lock_guard<std::mutex> lock(t->mutex);
+        if (combinators.size() < t->combinators.size()) {
+            combinators.resize(t->combinators.size(), 0);
+        }
+        for (size_t n = 0; n < t->combinators.size(); n++) {
+            combinators[n] += std::atomic_ref<uint64_t>(t->combinators[n]).load(
+                std::memory_order_relaxed);
+        }
+    }
+    auto frames = VMFrameCache::stats();
+
+    os << "{\"steps\": " << steps;
+    os << ", \"opcodes\": " << opcodes;
+    os << ", \"exceptions\": " << exceptions;
+    os << ", \"frames\": {\"reused\": " << frames.reused
+       << ", \"allocated\": " << frames.allocated << "}";
+    os << ", \"objects\": {";
+    for (size_t k = 0; k < VM_OBJECT_KINDS; k++) {
+        if (k > 0) os << ", ";
+        os << "\"" << kinds[k] << "\": " << objects[k];
+    }
+    os << "}, \"threads\": [";
+    for (auto t : tt) {
+        if (t != tt.front()) os << ", ";
+        os << "{\"id\": " << t->id << ", \"steps\": " << load(t->steps)
+           << ", \"wall_ns\": " << load(t->wall) << "}";
+    }
+    os << "], \"combinators\": {";
+    bool first = true;
+    for (size_t n = 0; n < combinators.size(); n++) {
+        if (combinators[n] == 0) continue;
+        if (!first) os << ", ";
+        first = false;
+        os << quote(vm->get_combinator_string(n)) << ": " << combinators[n];
+    }
+    os << "}}";
+}
+
+inline void VMStats::sample(thread_t &t, const VMObjectPtr &thunk) {
+    static constexpr size_t MAX_DEPTH = 128;
+
+    t.countdown = vm_runtime().stats_interval;
+
+    // the continuation k of a thunk is the thunk of its caller
+    std::vector<symbol_t> path;
+    auto k = thunk;
+    while ((k != nullptr) && (k->tag() == VM_OBJECT_ARRAY) &&
+           (path.size() < MAX_DEPTH)) {
+        auto kk = VM_OBJECT_ARRAY_VIEW(k);
+        if ((kk.size() < 5) || (kk[4] == nullptr)) break;
+        path.push_back(kk[4]->symbol());
+        VMObjectPtr next = kk[2];
+        k = next;
+    }
+
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.samples[path]++;
+}
+
+inline void VMStats::render_profile(std::ostream &os, VM *vm) {
+    auto tt = threads();
+
+    std::map<std::vector<symbol_t>, uint64_t> samples;
+    for (auto t : tt) {
+        std::lock_guard<std::mutex> lock(t->mutex);
+        for (auto &[path, n] : t->samples) {
+            samples[path] += n;
+        }
+    }
+
+    // frames are separated by ';' and the count by a space
+    for (auto &[path, n] : samples) {
+        std::string line;
+        for (auto s = path.rbegin(); s != path.rend(); s++) {
+            std::string name;
+            vm->get_combinator_string(*s).toUTF8String(name);
+            for (auto &c : name) {
+                if (c == ';' || c == ' ') c = '_';
+            }
+            if (!line.empty()) line += ';';
+            line += name;
+        }
+        os << line << ' ' << n << std::endl;
+    }
+}
 
 // here we can safely declare reduce
 inline VMObjectPtr VMObjectLiteral::reduce(const VMObjectPtr &thunk) const {
@@ -931,12 +2087,7 @@ inline VMObjectPtr VMObjectLiteral::reduce(const VMObjectPtr &thunk) const {
         auto rti = tt->get(1);
         auto k = tt->get(2);
 
-        VMObjectPtrs vv;
-        for (size_t n = 4; n < tt->size(); n++) {
-            vv.push_back(tt->get(n));
-        }
-
-        auto r = VMObjectArray::create(vv);
+        auto r = VMObjectArray::create(tt->view().subspan(4));
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
         auto rta = VM_OBJECT_ARRAY_CAST(rt);
@@ -947,29 +2098,24 @@ inline VMObjectPtr VMObjectLiteral::reduce(const VMObjectPtr &thunk) const {
 };
 
 inline VMObjectPtr VMObjectArray::reduce(const VMObjectPtr &thunk) const {
-    auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
-    auto rt = tt[0];
-    auto rti = tt[1];
-    auto k = tt[2];
-    auto exc = tt[3];
-    auto c = tt[4];
-
-    VMObjectPtrs vv;
-    vv.push_back(rt);
-    vv.push_back(rti);
-    vv.push_back(k);
-    vv.push_back(exc);
-    auto aa = VM_OBJECT_ARRAY_VALUE(c);
+    // splice the array into the thunk: rt, rti, k, exc, c0 .. cn, args
+    auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
+    auto aa = VM_OBJECT_ARRAY_VIEW(tt[4]);
+
+    auto t = allocate(4 + aa.size() + (tt.size() - 5));
+    auto vv = t->slots();
+    size_t i = 0;
+    for (size_t n = 0; n < 4; n++) {
+        vv[i++] = tt[n];
+    }
     for (auto &a : aa) {
-        vv.push_back(a);
+        vv[i++] = a;
     }
-    for (unsigned int n = 5; n < tt.size(); n++) {
-        vv.push_back(tt[n]);
+    for (size_t n = 5; n < tt.size(); n++) {
+        vv[i++] = tt[n];
     }
 
-    auto t = VMObjectArray::create(vv);
-
-    return t;
+    return VMObjectPtr(t);
 }
 
 class VMObjectOpaque : public VMObject {
@@ -1008,7 +2154,7 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -1017,11 +2163,7 @@ public:
 
         VMObjectPtr ret;
         if (tt.size() > 5) {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            ret = VMObjectArray::create(rr);
+            ret = VMObjectArray::create(tt.subspan(4));
         } else {
             ret = tt[4];
         }
@@ -1049,9 +2191,9 @@ private:
     symbol_t _symbol;
 };
 
-using VMObjectOpaquePtr = std::shared_ptr<VMObjectOpaque>;
+using VMObjectOpaquePtr = VMObjectRef<VMObjectOpaque>;
 #define VM_OBJECT_OPAQUE_TEST(a) (a->tag() == VM_OBJECT_OPAQUE)
-#define VM_OBJECT_OPAQUE_CAST(a) std::static_pointer_cast<VMObjectOpaque>(a)
+#define VM_OBJECT_OPAQUE_CAST(a) vm_object_cast<VMObjectOpaque>(a)
 #define VM_OBJECT_OPAQUE_COMPARE(o0, o1) \
     (VM_OBJECT_OPAQUE_CAST(o0))->compare(o1);
 #define VM_OBJECT_OPAQUE_SYMBOL(a) (VM_OBJECT_OPAQUE_CAST(a)->symbol())
@@ -1088,10 +2230,17 @@ public:
     }
 
     icu::UnicodeString text() const {
-        if (_symbol == SYMBOL_NIL) {
-            return "{}";
-        } else {
-            return _machine->get_combinator_string(_symbol);
+        switch (_symbol) {
+            case SYMBOL_NONE:  // immediates don't know their machine
+                return "System::none";
+            case SYMBOL_TRUE:
+                return "System::true";
+            case SYMBOL_FALSE:
+                return "System::false";
+            case SYMBOL_NIL:
+                return "{}";
+            default:
+                return _machine->get_combinator_string(_symbol);
         }
     }
 
@@ -1103,6 +2252,16 @@ public:
         os << text();
     }
 
+protected:
+    // the thunk which passes e to the exception handler exc
+    static VMObjectPtr exception_thunk(const VMObjectPtr &exc,
+                                       const VMObjectPtr &e) {
+        VMStats::count_exception();
+        auto ee = VM_OBJECT_ARRAY_VIEW(exc);
+        VMObjectPtr rr[] = {ee[0], ee[1], ee[2], ee[3], ee[4], e};
+        return VMObjectArray::create(rr, 6);
+    }
+
 private:
     VM *_machine;
     symbol_t _symbol;
@@ -1129,7 +2288,11 @@ public:
     }
 
     static VMObjectPtr create(VM *vm, const symbol_t s) {
-        return std::make_shared<VMObjectData>(vm, s);
+        if ((s == SYMBOL_NONE) || (s == SYMBOL_TRUE) || (s == SYMBOL_FALSE)) {
+            return VMObjectPtr::immediate_constant(s);
+        } else {
+            return VMObjectPtr(new VMObjectData(vm, s));
+        }
     }
 
     static VMObjectPtr create(VM *vm, const icu::UnicodeString &s) {
@@ -1150,7 +2313,7 @@ public:
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -1159,11 +2322,7 @@ public:
 
         VMObjectPtr ret;
         if (tt.size() > 5) {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            ret = VMObjectArray::create(rr);
+            ret = VMObjectArray::create(tt.subspan(4));
         } else {
             ret = tt[4];
         }
@@ -1175,13 +2334,33 @@ public:
         return k;
     }
 };
-using VMObjectDataPtr = std::shared_ptr<VMObjectData>;
+using VMObjectDataPtr = VMObjectRef<VMObjectData>;
+
+// here we can safely materialize immediates
+static_assert(sizeof(VMObjectInteger) <= 6 * sizeof(void *));
+static_assert(sizeof(VMObjectChar) <= 6 * sizeof(void *));
+static_assert(sizeof(VMObjectData) <= 6 * sizeof(void *));
+
+inline VMObjectProxy::VMObjectProxy(uintptr_t bits) {
+    if ((bits & 0x3) == VM_IMMEDIATE_INTEGER) {
+        _object = new (_storage) VMObjectInteger(((vm_int_t)bits) >> 2);
+    } else if ((bits & 0x7) == VM_IMMEDIATE_CHAR) {
+        _object = new (_storage) VMObjectChar((vm_char_t)(bits >> 3));
+    } else {
+        _object = new (_storage) VMObjectData(nullptr, (symbol_t)(bits >> 3));
+    }
+    if (VMStats::enabled()) VMStats::uncount_object(_object->tag());
+}
 
-using VMObjectCombinatorPtr = std::shared_ptr<VMObjectCombinator>;
+inline std::ostream &operator<<(std::ostream &os, const VMObjectPtr &a) {
+    a->render(os);
+    return os;
+}
+
+using VMObjectCombinatorPtr = VMObjectRef<VMObjectCombinator>;
 #define VM_OBJECT_COMBINATOR_TEST(a) (a->tag() == VM_OBJECT_COMBINATOR)
-#define VM_OBJECT_COMBINATOR_CAST(a) \
-    std::static_pointer_cast<VMObjectCombinator>(a)
-#define VM_OBJECT_COMBINATOR_SYMBOL(a) (VM_OBJECT_COMBINATOR_CAST(a)->symbol())
+#define VM_OBJECT_COMBINATOR_CAST(a) vm_object_cast<VMObjectCombinator>(a)
+#define VM_OBJECT_COMBINATOR_SYMBOL(a) (a->symbol())
 #define VM_OBJECT_DATA_TEST(a) (a->subtag_test(VM_SUB_DATA))
 
 struct CompareVMObjectPtr {
@@ -1255,8 +2434,8 @@ struct CompareVMObjectPtr {
                         return 0;
                 } break;
                 case VM_OBJECT_ARRAY: {
-                    auto v0 = VM_OBJECT_ARRAY_VALUE(a0);
-                    auto v1 = VM_OBJECT_ARRAY_VALUE(a1);
+                    auto v0 = VM_OBJECT_ARRAY_VIEW(a0);
+                    auto v1 = VM_OBJECT_ARRAY_VIEW(a1);
                     auto s0 = v0.size();
                     auto s1 = v1.size();
 
@@ -1310,11 +2489,11 @@ public:
     }
 
     static VMObjectPtr create(VM *m, const symbol_t s) {
-        return std::make_shared<VMObjectStub>(m, s);
+        return VMObjectPtr(new VMObjectStub(m, s));
     }
 
     static VMObjectPtr create(VM *m, const UnicodeString &s) {
-        return std::make_shared<VMObjectStub>(m, s);
+        return VMObjectPtr(new VMObjectStub(m, s));
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
@@ -1335,14 +2514,14 @@ public:
     }
 
     static VMObjectPtr create(VM *m) {
-        return std::make_shared<VMThrow>(m);
+        return VMObjectPtr(new VMThrow(m));
     }
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
         // when throw is reduced, it takes the exception, inserts it argument,
         // and reduces that
 
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         // auto rt  = tt[0];
         // auto rti = tt[1];
         // auto k   = tt[2];
@@ -1353,6 +2532,7 @@ public:
         auto ee = VM_OBJECT_ARRAY_CAST(exc);
         ee->set(5, r);
 
+        VMStats::count_exception();
         return exc;
     }
 };
@@ -1394,7 +2574,7 @@ public:
     virtual VMObjectPtr apply() const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -1403,43 +2583,23 @@ public:
         if (tt.size() > 4) {
             try {
                 r = apply();
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
-                }
             } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
             }
-        } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
             }
-            r = VMObjectArray::create(rr);
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
+            }
+        } else {
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
         // also return spurious arguments
         if (tt.size() > 5) {
-            VMObjectPtrs rr;
-            rr.push_back(r);
-            for (unsigned int i = 5; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(r, tt.subspan(5));
         }
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
@@ -1458,7 +2618,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {    \
     }                                               \
     static VMObjectPtr create(VM *m) {              \
-        return std::shared_ptr<c>(new c(m));        \
+        return VMObjectPtr(new c(m));               \
     }
 
 class MedadicCallback : Medadic {
@@ -1528,54 +2688,34 @@ public:
     virtual VMObjectPtr apply(const VMObjectPtr &arg0) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
 
         VMObjectPtr r;
         if (tt.size() > 5) {
-            auto arg0 = tt[5];
+            const auto &arg0 = tt[5];
 
             try {
                 r = apply(arg0);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
-                }
             } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
             }
-        } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
             }
-            r = VMObjectArray::create(rr);
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
+            }
+        } else {
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
         // also return spurious arguments
         if (tt.size() > 6) {
-            VMObjectPtrs rr;
-            rr.push_back(r);
-            for (unsigned int i = 6; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(r, tt.subspan(6));
         }
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
@@ -1594,7 +2734,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {    \
     }                                               \
     static VMObjectPtr create(VM *m) {              \
-        return std::shared_ptr<c>(new c(m));        \
+        return VMObjectPtr(new c(m));               \
     }
 
 class MonadicCallback : public Monadic {
@@ -1622,7 +2762,7 @@ public:
         std::function<VMObjectPtr(const VMObjectPtr &a0)> f) {
         // return std::shared_ptr<MonadicCallback>(new MonadicCallback(m, sym,
         // f));
-        return std::shared_ptr<MonadicCallback>(new MonadicCallback(m, sym, f));
+        return VMObjectPtr(new MonadicCallback(m, sym, f));
     }
 
     static VMObjectPtr create(
@@ -1673,58 +2813,35 @@ public:
                               const VMObjectPtr &arg1) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto m = machine();
-        auto rt = m->array_get(thunk, 0);
-        auto rti = m->array_get(thunk, 1);
-        auto k = m->array_get(thunk, 2);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
+        auto rt = tt[0];
+        auto rti = tt[1];
+        auto k = tt[2];
 
         VMObjectPtr r;
-        if (m->array_size(thunk) > 6) {
-            auto arg0 = m->array_get(thunk, 5);
-            auto arg1 = m->array_get(thunk, 6);
+        if (tt.size() > 6) {
+            const auto &arg0 = tt[5];
+            const auto &arg1 = tt[6];
 
             try {
                 r = apply(arg0, arg1);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4;
-                         i < (unsigned int)m->array_size(thunk); i++) {
-                        rr.push_back(m->array_get(thunk, i));
-                    }
-                    r = VMObjectArray::create(rr);
-                }
             } catch (VMObjectPtr e) {
-                auto exc = m->array_get(thunk, 3);
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
             }
-        } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < (unsigned int)m->array_size(thunk);
-                 i++) {
-                rr.push_back(m->array_get(thunk, i));
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
+            }
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
             }
-            r = VMObjectArray::create(rr);
+        } else {
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
         // also return spurious arguments
-        if (m->array_size(thunk) > 7) {
-            VMObjectPtrs rr;
-            rr.push_back(r);
-            for (unsigned int i = 7; i < (unsigned int)m->array_size(thunk);
-                 i++) {
-                rr.push_back(m->array_get(thunk, i));
-            }
-            r = VMObjectArray::create(rr);
+        if (tt.size() > 7) {
+            r = VMObjectArray::create(r, tt.subspan(7));
         }
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
@@ -1743,7 +2860,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {   \
     }                                              \
     static VMObjectPtr create(VM *m) {             \
-        return std::shared_ptr<c>(new c(m));       \
+        return VMObjectPtr(new c(m));              \
     }
 
 class DyadicCallback : public Dyadic {
@@ -1830,56 +2947,36 @@ public:
                               const VMObjectPtr &arg2) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
 
         VMObjectPtr r;
         if (tt.size() > 7) {
-            auto arg0 = tt[5];
-            auto arg1 = tt[6];
-            auto arg2 = tt[7];
+            const auto &arg0 = tt[5];
+            const auto &arg1 = tt[6];
+            const auto &arg2 = tt[7];
 
             try {
                 r = apply(arg0, arg1, arg2);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
-                }
             } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
             }
-        } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
             }
-            r = VMObjectArray::create(rr);
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
+            }
+        } else {
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
         // also return spurious arguments
         if (tt.size() > 8) {
-            VMObjectPtrs rr;
-            rr.push_back(r);
-            for (unsigned int i = 8; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(r, tt.subspan(8));
         }
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
@@ -1898,7 +2995,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {    \
     }                                               \
     static VMObjectPtr create(VM *m) {              \
-        return std::shared_ptr<c>(new c(m));        \
+        return VMObjectPtr(new c(m));               \
     }
 
 class TriadicCallback : public Triadic {
@@ -1986,50 +3083,30 @@ public:
         : VMObjectCombinator(t, m, s) {
     }
 
-    virtual VMObjectPtr apply(const VMObjectPtrs &args) const = 0;
+    virtual VMObjectPtr apply(const VMObjectPtrView &args) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
 
         VMObjectPtr r;
         if (tt.size() > 4) {
-            VMObjectPtrs args;
-            for (unsigned int i = 5; i < tt.size(); i++) {
-                args.push_back(tt[i]);
-            }
-
             try {
-                r = apply(args);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
-                }
+                r = apply(tt.subspan(5));
             } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
             }
-        } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
+            }
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
             }
-            r = VMObjectArray::create(rr);
+        } else {
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
         auto index = VM_OBJECT_INTEGER_VALUE(rti);
@@ -2048,7 +3125,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {     \
     }                                                \
     static VMObjectPtr create(VM *m) {               \
-        return std::shared_ptr<c>(new c(m));         \
+        return VMObjectPtr(new c(m));                \
     }
 
 /*
@@ -2120,7 +3197,7 @@ public:
     virtual VMObjectPtr apply(const VMObjectPtr &arg0) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -2128,44 +3205,29 @@ public:
 
         VMObjectPtr r;
         if (tt.size() > 5) {
-            auto arg0 = tt[5];
+            const auto &arg0 = tt[5];
 
             try {
                 r = apply(arg0);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
+            } catch (VMObjectPtr e) {
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
+            }
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
+            }
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
 
-                    auto index = VM_OBJECT_INTEGER_VALUE(rti);
-                    auto rta = VM_OBJECT_ARRAY_CAST(rt);
-                    rta->set(index, r);
+                auto index = VM_OBJECT_INTEGER_VALUE(rti);
+                auto rta = VM_OBJECT_ARRAY_CAST(rt);
+                rta->set(index, r);
 
-                    return k;
-                }
-            } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                return k;
             }
         } else {
             // This seems the way to go about it.. Check Binary etc. for this.
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(tt.subspan(4));
             auto index = VM_OBJECT_INTEGER_VALUE(rti);
             auto rta = VM_OBJECT_ARRAY_CAST(rt);
             rta->set(index, r);
@@ -2173,17 +3235,9 @@ public:
             return k;
         }
 
-        VMObjectPtrs kk;
-        kk.push_back(rt);
-        kk.push_back(rti);
-        kk.push_back(k);
-        kk.push_back(exc);
-        kk.push_back(r);
-        for (unsigned int n = 6; n < tt.size(); n++) {
-            kk.push_back(tt[n]);
-        }
+        VMObjectPtr kk[] = {rt, rti, k, exc, r};
 
-        return VMObjectArray::create(kk);
+        return VMObjectArray::create(kk, tt.subspan(6));
     }
 };
 
@@ -2195,7 +3249,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {  \
     }                                             \
     static VMObjectPtr create(VM *m) {            \
-        return std::shared_ptr<c>(new c(m));      \
+        return VMObjectPtr(new c(m));             \
     }
 
 class Binary : public VMObjectCombinator {
@@ -2213,7 +3267,7 @@ public:
                               const VMObjectPtr &arg1) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -2221,57 +3275,34 @@ public:
 
         VMObjectPtr r;
         if (tt.size() > 6) {
-            auto arg0 = tt[5];
-            auto arg1 = tt[6];
+            const auto &arg0 = tt[5];
+            const auto &arg1 = tt[6];
 
             try {
                 r = apply(arg0, arg1);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
+            } catch (VMObjectPtr e) {
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
+            }
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
+            }
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
 
-                    auto index = VM_OBJECT_INTEGER_VALUE(rti);
-                    auto rta = VM_OBJECT_ARRAY_CAST(rt);
-                    rta->set(index, r);
+                auto index = VM_OBJECT_INTEGER_VALUE(rti);
+                auto rta = VM_OBJECT_ARRAY_CAST(rt);
+                rta->set(index, r);
 
-                    return k;
-                }
-            } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                return k;
             }
         } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
-        VMObjectPtrs kk;
-        kk.push_back(rt);
-        kk.push_back(rti);
-        kk.push_back(k);
-        kk.push_back(exc);
-        kk.push_back(r);
-        for (unsigned int n = 7; n < tt.size(); n++) {
-            kk.push_back(tt[n]);
-        }
+        VMObjectPtr kk[] = {rt, rti, k, exc, r};
 
-        return VMObjectArray::create(kk);
+        return VMObjectArray::create(kk, tt.subspan(7));
     }
 };
 
@@ -2283,7 +3314,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {   \
     }                                              \
     static VMObjectPtr create(VM *m) {             \
-        return std::shared_ptr<c>(new c(m));       \
+        return VMObjectPtr(new c(m));              \
     }
 
 class Ternary : public VMObjectCombinator {
@@ -2301,7 +3332,7 @@ public:
                               const VMObjectPtr &arg2) const = 0;
 
     VMObjectPtr reduce(const VMObjectPtr &thunk) const override {
-        auto tt = VM_OBJECT_ARRAY_VALUE(thunk);
+        auto tt = VM_OBJECT_ARRAY_VIEW(thunk);
         auto rt = tt[0];
         auto rti = tt[1];
         auto k = tt[2];
@@ -2309,58 +3340,35 @@ public:
 
         VMObjectPtr r;
         if (tt.size() > 7) {
-            auto arg0 = tt[5];
-            auto arg1 = tt[6];
-            auto arg2 = tt[7];
+            const auto &arg0 = tt[5];
+            const auto &arg1 = tt[6];
+            const auto &arg2 = tt[7];
 
             try {
                 r = apply(arg0, arg1, arg2);
-                if (r == nullptr) {
-                    VMObjectPtrs rr;
-                    for (unsigned int i = 4; i < tt.size(); i++) {
-                        rr.push_back(tt[i]);
-                    }
-                    r = VMObjectArray::create(rr);
+            } catch (VMObjectPtr e) {
+                // legacy modules still throw
+                return exception_thunk(tt[3], e);
+            }
+            if (r.is_raise_sentinel()) {
+                return exception_thunk(tt[3], machine()->raised());
+            }
+            if (r == nullptr) {
+                r = VMObjectArray::create(tt.subspan(4));
 
-                    auto index = VM_OBJECT_INTEGER_VALUE(rti);
-                    auto rta = VM_OBJECT_ARRAY_CAST(rt);
-                    rta->set(index, r);
+                auto index = VM_OBJECT_INTEGER_VALUE(rti);
+                auto rta = VM_OBJECT_ARRAY_CAST(rt);
+                rta->set(index, r);
 
-                    return k;
-                }
-            } catch (VMObjectPtr e) {
-                auto exc = tt[3];
-                auto ee = VM_OBJECT_ARRAY_VALUE(exc);
-
-                VMObjectPtrs rr;
-                rr.push_back(ee[0]);
-                rr.push_back(ee[1]);
-                rr.push_back(ee[2]);
-                rr.push_back(ee[3]);
-                rr.push_back(ee[4]);
-                rr.push_back(e);
-
-                return VMObjectArray::create(rr);
+                return k;
             }
         } else {
-            VMObjectPtrs rr;
-            for (unsigned int i = 4; i < tt.size(); i++) {
-                rr.push_back(tt[i]);
-            }
-            r = VMObjectArray::create(rr);
+            r = VMObjectArray::create(tt.subspan(4));
         }
 
-        VMObjectPtrs kk;
-        kk.push_back(rt);
-        kk.push_back(rti);
-        kk.push_back(k);
-        kk.push_back(exc);
-        kk.push_back(r);
-        for (unsigned int n = 8; n < tt.size(); n++) {
-            kk.push_back(tt[n]);
-        }
+        VMObjectPtr kk[] = {rt, rti, k, exc, r};
 
-        return VMObjectArray::create(kk);
+        return VMObjectArray::create(kk, tt.subspan(8));
     }
 };
 
@@ -2372,7 +3380,7 @@ public:
     c(const c &o) : c(o.machine(), o.symbol()) {    \
     }                                               \
     static VMObjectPtr create(VM *m) {              \
-        return std::shared_ptr<c>(new c(m));        \
+        return VMObjectPtr(new c(m));               \
     }
 
 // 'pretty' printing
@@ -2382,7 +3390,7 @@ inline void render_tuple(const VMObjectPtr &tt, std::ostream &os) {
         os << '.';
     } else if (tt->tag() == VM_OBJECT_ARRAY) {
         os << '(';
-        auto vv = VM_OBJECT_ARRAY_VALUE(tt);
+        auto vv = VM_OBJECT_ARRAY_VIEW(tt);
         int sz = (int)vv.size();
         if (sz == 2) {  // NOTE, handle 'tuple 0 = (0,)' differently
             if (vv[0] == nullptr) {
@@ -2426,7 +3434,7 @@ inline void render_array_raw(const VMObjectPtr &ee, std::ostream &os) {
     if (ee == nullptr) {
         os << '.';
     } else if (ee->tag() == VM_OBJECT_ARRAY) {
-        auto vv = VM_OBJECT_ARRAY_VALUE(ee);
+        auto vv = VM_OBJECT_ARRAY_VIEW(ee);
         os << '(';
         bool first = true;
         for (auto &v : vv) {
@@ -2460,14 +3468,13 @@ inline bool is_well_formed_const(const VMObjectPtr &ee) {
     if (ee == nullptr) {
         return false;
     } else if (ee->tag() == VM_OBJECT_ARRAY) {
-        auto v = VM_OBJECT_ARRAY_VALUE(ee);
+        auto v = VM_OBJECT_ARRAY_VIEW(ee);
         if (v.size() != 3) {
             return false;
         } else {
             auto head = v[0];
             if (head->tag() == VM_OBJECT_COMBINATOR) {
-                auto h = VM_OBJECT_COMBINATOR_CAST(head);
-                return h->symbol() == SYMBOL_CONS;
+                return head->symbol() == SYMBOL_CONS;
             } else {
                 return false;
             }
@@ -2482,7 +3489,7 @@ inline void render_cons_elements(const VMObjectPtr &ee, std::ostream &os) {
         os << '.';
     } else if (is_well_formed_nil(ee)) {
     } else if (is_well_formed_const(ee)) {
-        auto v = VM_OBJECT_ARRAY_VALUE(ee);
+        auto v = VM_OBJECT_ARRAY_VIEW(ee);
         if ((v[2] != nullptr) && is_well_formed_nil(v[2])) {
             if (v[1] == nullptr) {
                 os << ".";